@@ -0,0 +1,67 @@
+-- Benchmark: sorting and indexing Ethiopian date text under the database
+-- collation versus the "C"-collated ethiopian_date_text domain.
+--
+-- Usage:
+--   psql -d DATABASE -v rows=1000000 -f bench/collation_sort.sql
+--   psql -d DATABASE -v profile=dup -f bench/collation_sort.sql   # bench_workload_dup
+--
+-- Both columns hold identical "YYYY-MM-DD" strings; only the collation differs.
+-- Compare the "Time:" lines printed for each pair of statements.
+
+\set ON_ERROR_STOP on
+\if :{?rows}
+\else
+\set rows 1000000
+\endif
+
+CREATE EXTENSION IF NOT EXISTS pg_ethiopian_calendar;
+
+DROP TABLE IF EXISTS bench_collation;
+
+\if :{?profile}
+\set source bench_workload_ :profile
+CREATE TABLE bench_collation AS
+SELECT ts,
+       to_ethiopian_date(ts)      AS eth_default,
+       to_ethiopian_date_text(ts) AS eth_c
+FROM :source;
+\else
+CREATE TABLE bench_collation AS
+SELECT ts,
+       to_ethiopian_date(ts)      AS eth_default,
+       to_ethiopian_date_text(ts) AS eth_c
+FROM (
+    SELECT timestamp '1950-01-01' + random() * interval '100 years' AS ts
+    FROM generate_series(1, :rows)
+) s;
+\endif
+
+VACUUM ANALYZE bench_collation;
+
+SELECT current_setting('lc_collate') AS database_collation,
+       count(*) AS rows
+FROM bench_collation;
+
+-- Keep every sort in memory so the comparison measures comparator cost only.
+SET work_mem = '1GB';
+SET max_parallel_workers_per_gather = 0;
+SET maintenance_work_mem = '1GB';
+SET max_parallel_maintenance_workers = 0;
+
+\timing on
+
+\echo '== ORDER BY: database collation =='
+SELECT count(*) FROM (SELECT eth_default FROM bench_collation ORDER BY eth_default OFFSET 0) s;
+
+\echo '== ORDER BY: ethiopian_date_text ("C") =='
+SELECT count(*) FROM (SELECT eth_c FROM bench_collation ORDER BY eth_c OFFSET 0) s;
+
+\echo '== CREATE INDEX: database collation =='
+CREATE INDEX bench_collation_default_idx ON bench_collation (eth_default);
+
+\echo '== CREATE INDEX: ethiopian_date_text ("C") =='
+CREATE INDEX bench_collation_c_idx ON bench_collation (eth_c);
+
+\timing off
+
+DROP TABLE bench_collation;
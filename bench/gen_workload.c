@@ -0,0 +1,296 @@
+/*
+ * gen_workload.c
+ *
+ * Reproducible synthetic timestamps for the benchmarks, written as CSV
+ * (id,gregorian_timestamp,ethiopian_date) to stdout. The Ethiopian column
+ * is computed with the extension's own kernels (src/ethiopian_core.h), so
+ * it doubles as expected output for conversion and parsing benchmarks.
+ *
+ * Profiles:
+ *   dup     heavy day-level duplication: rows spread over few distinct days
+ *   recent  exponentially skewed towards an anchor date, with bursts
+ *   pagume  half the rows on Pagumē and the days around it
+ *   wide    uniform over the whole supported range (8 CE to 9999 CE)
+ *
+ * Build and run:
+ *   cc -O2 -I src -o gen_workload bench/gen_workload.c -lm
+ *   ./gen_workload -p recent -n 1000000 -s 42 > recent.csv
+ *
+ * The same profile, row count and seed always give the same file.
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ethiopian_core.h"
+
+#define SECS_PER_DAY 86400
+
+/* Last supported Gregorian day, 9999-12-31 */
+#define MAX_JDN 5373484
+
+typedef struct
+{
+    const char *profile;
+    long        rows;
+    uint64_t    seed;
+    int         distinct_days;  /* dup */
+    int         anchor_jdn;     /* dup, recent */
+} Options;
+
+/* splitmix64: small, fast and identical on every platform */
+static uint64_t rng_state;
+
+static uint64_t
+rng_next(void)
+{
+    uint64_t z = (rng_state += 0x9e3779b97f4a7c15ULL);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/* Uniform in [0, n) */
+static int
+rng_below(int n)
+{
+    return (int) (rng_next() % (uint64_t) n);
+}
+
+/* Uniform in (0, 1] */
+static double
+rng_unit(void)
+{
+    return ((rng_next() >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+/* Heavy duplication: distinct_days days ending at the anchor, Zipf-like weights */
+static int
+gen_dup(const Options *opt, int *secs)
+{
+    int rank = (int) (pow(opt->distinct_days, rng_unit()) - 1);
+
+    /* Office hours only, on whole minutes */
+    *secs = (8 + rng_below(10)) * 3600 + rng_below(60) * 60;
+    return opt->anchor_jdn - rank;
+}
+
+/*
+ * Recent skew: age in days is exponential with a 30-day mean; one row in five
+ * falls in a one-hour burst on one of BURSTS days within the last year.
+ */
+#define BURSTS 16
+
+static int burst_age[BURSTS];
+static int burst_hour[BURSTS];
+
+static int
+gen_recent(const Options *opt, int *secs)
+{
+    if (rng_below(5) == 0)
+    {
+        int burst = rng_below(BURSTS);
+
+        *secs = burst_hour[burst] * 3600 + rng_below(3600);
+        return opt->anchor_jdn - burst_age[burst];
+    }
+
+    *secs = rng_below(SECS_PER_DAY);
+    return opt->anchor_jdn - (int) (-30.0 * log(rng_unit()));
+}
+
+/* Pagumē-heavy: Nehase 30, Pagumē 1-5/6 and Meskerem 1 of random years 1900-2100 EC */
+static int
+gen_pagume(const Options *opt, int *secs)
+{
+    int year;
+    int day;
+
+    (void) opt;
+    *secs = rng_below(SECS_PER_DAY);
+
+    if (rng_below(2))
+        return ETHIOPIAN_EPOCH + rng_below(MAX_JDN - ETHIOPIAN_EPOCH + 1);
+
+    year = 1900 + rng_below(201);
+    day = rng_below(8);             /* 0 = Nehase 30, 7 = Meskerem 1 */
+    if (day == 0)
+        return ethiopian_to_jdn(year, 12, 30);
+    if (day == 7 || (day == 6 && year % 4 != 3))
+        return ethiopian_to_jdn(year + 1, 1, 1);
+    return ethiopian_to_jdn(year, 13, day);
+}
+
+/* Uniform over every supported day */
+static int
+gen_wide(const Options *opt, int *secs)
+{
+    (void) opt;
+    *secs = rng_below(SECS_PER_DAY);
+    return ETHIOPIAN_EPOCH + rng_below(MAX_JDN - ETHIOPIAN_EPOCH + 1);
+}
+
+typedef int (*Generator) (const Options *opt, int *secs);
+
+static const struct
+{
+    const char *name;
+    Generator   gen;
+} profiles[] = {
+    {"dup", gen_dup},
+    {"recent", gen_recent},
+    {"pagume", gen_pagume},
+    {"wide", gen_wide},
+};
+
+/* Writes n as exactly width digits, zero-padded */
+static char *
+put_digits(char *p, int n, int width)
+{
+    for (int i = width - 1; i >= 0; i--)
+    {
+        p[i] = '0' + n % 10;
+        n /= 10;
+    }
+    return p + width;
+}
+
+/* Writes a year as in to_ethiopian_date(): at least four digits */
+static char *
+put_year(char *p, int year)
+{
+    return put_digits(p, year, year >= 10000 ? 5 : 4);
+}
+
+static char *
+put_row(char *p, long id, int jdn, int secs)
+{
+    int year, month, day;
+
+    p += sprintf(p, "%ld,", id);
+
+    jdn_to_gregorian(jdn, &year, &month, &day);
+    p = put_year(p, year);
+    *p++ = '-';
+    p = put_digits(p, month, 2);
+    *p++ = '-';
+    p = put_digits(p, day, 2);
+    *p++ = ' ';
+    p = put_digits(p, secs / 3600, 2);
+    *p++ = ':';
+    p = put_digits(p, secs / 60 % 60, 2);
+    *p++ = ':';
+    p = put_digits(p, secs % 60, 2);
+    *p++ = ',';
+
+    jdn_to_ethiopian(jdn, &year, &month, &day);
+    p = put_year(p, year);
+    *p++ = '-';
+    p = put_digits(p, month, 2);
+    *p++ = '-';
+    p = put_digits(p, day, 2);
+    *p++ = '\n';
+    return p;
+}
+
+static void
+usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [-p dup|recent|pagume|wide] [-n rows] [-s seed]\n"
+            "          [-d distinct_days] [-a anchor_yyyy-mm-dd]\n"
+            "defaults: -p wide -n 1000000 -s 42 -d 365 -a 2025-01-01\n",
+            prog);
+    exit(2);
+}
+
+static long
+parse_long(const char *arg, const char *prog)
+{
+    char   *end;
+    long    v;
+
+    errno = 0;
+    v = strtol(arg, &end, 10);
+    if (errno || *end || v < 0)
+        usage(prog);
+    return v;
+}
+
+int
+main(int argc, char **argv)
+{
+    Options     opt = {"wide", 1000000, 42, 365, 0};
+    Generator   gen = NULL;
+    int         year = 2025, month = 1, day = 1;
+    int         c;
+    static char buf[1 << 16];
+    char       *p = buf;
+
+    while ((c = getopt(argc, argv, "p:n:s:d:a:h")) != -1)
+    {
+        switch (c)
+        {
+            case 'p':
+                opt.profile = optarg;
+                break;
+            case 'n':
+                opt.rows = parse_long(optarg, argv[0]);
+                break;
+            case 's':
+                opt.seed = (uint64_t) parse_long(optarg, argv[0]);
+                break;
+            case 'd':
+                opt.distinct_days = (int) parse_long(optarg, argv[0]);
+                if (opt.distinct_days < 1)
+                    usage(argv[0]);
+                break;
+            case 'a':
+                if (sscanf(optarg, "%d-%d-%d", &year, &month, &day) != 3)
+                    usage(argv[0]);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(profiles) / sizeof(profiles[0]); i++)
+        if (strcmp(opt.profile, profiles[i].name) == 0)
+            gen = profiles[i].gen;
+    if (gen == NULL)
+        usage(argv[0]);
+
+    opt.anchor_jdn = gregorian_to_jdn(year, month, day);
+    rng_state = opt.seed;
+    for (int i = 0; i < BURSTS; i++)
+    {
+        burst_age[i] = rng_below(365);
+        burst_hour[i] = rng_below(24);
+    }
+
+    for (long id = 1; id <= opt.rows; id++)
+    {
+        int secs;
+        int jdn = gen(&opt, &secs);
+
+        /* Keep every row convertible */
+        if (jdn < ETHIOPIAN_EPOCH)
+            jdn = ETHIOPIAN_EPOCH;
+
+        p = put_row(p, id, jdn, secs);
+        if (p - buf > (long) sizeof(buf) - 64)
+        {
+            fwrite(buf, 1, p - buf, stdout);
+            p = buf;
+        }
+    }
+    fwrite(buf, 1, p - buf, stdout);
+
+    return ferror(stdout) ? 1 : 0;
+}
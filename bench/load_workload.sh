@@ -0,0 +1,57 @@
+#!/bin/bash
+# Loads the synthetic workload profiles into PostgreSQL with COPY.
+#
+# Builds bench/gen_workload.c and streams its CSV straight into
+# bench_workload_<profile> (UNLOGGED) through psql's \copy, so nothing is
+# written to disk unless CSV_DIR is set. Connection settings come from the
+# usual PG* environment variables.
+#
+# Usage:
+#   bench/load_workload.sh                      # all profiles
+#   ROWS=10000000 SEED=7 bench/load_workload.sh dup recent
+#   CSV_DIR=/tmp/workload bench/load_workload.sh wide   # also keep the CSV
+#
+# Table: bench_workload_<profile> (id bigint, ts timestamp, eth_date text)
+#   eth_date is the expected to_ethiopian_date(ts), computed by the
+#   extension's C kernels in the generator.
+
+set -euo pipefail
+
+ROWS="${ROWS:-1000000}"
+SEED="${SEED:-42}"
+CC="${CC:-cc}"
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+GEN="${TMPDIR:-/tmp}/gen_workload.$$"
+PROFILES=("$@")
+if [ ${#PROFILES[@]} -eq 0 ]; then
+    PROFILES=(dup recent pagume wide)
+fi
+
+trap 'rm -f "$GEN"' EXIT
+"$CC" -O2 -I "$ROOT/src" -o "$GEN" "$ROOT/bench/gen_workload.c" -lm
+
+for profile in "${PROFILES[@]}"; do
+    table="bench_workload_${profile}"
+    echo "Loading ${table} (${ROWS} rows, seed ${SEED})..."
+
+    psql -X -q -v ON_ERROR_STOP=1 <<SQL
+DROP TABLE IF EXISTS ${table};
+CREATE UNLOGGED TABLE ${table} (id bigint, ts timestamp, eth_date text);
+SQL
+
+    if [ -n "${CSV_DIR:-}" ]; then
+        mkdir -p "$CSV_DIR"
+        "$GEN" -p "$profile" -n "$ROWS" -s "$SEED" | tee "$CSV_DIR/${profile}.csv" |
+            psql -X -q -v ON_ERROR_STOP=1 -c "\\copy ${table} FROM STDIN (FORMAT csv)"
+    else
+        "$GEN" -p "$profile" -n "$ROWS" -s "$SEED" |
+            psql -X -q -v ON_ERROR_STOP=1 -c "\\copy ${table} FROM STDIN (FORMAT csv)"
+    fi
+
+    psql -X -q -v ON_ERROR_STOP=1 -c "VACUUM ANALYZE ${table}"
+done
+
+psql -X -v ON_ERROR_STOP=1 -c "
+SELECT relname AS workload, reltuples::bigint AS rows,
+       pg_size_pretty(pg_table_size(oid)) AS size
+FROM pg_class WHERE relname LIKE 'bench\\_workload\\_%' ORDER BY relname"
@@ -0,0 +1,67 @@
+-- Benchmark: CPU instructions per row of the conversion functions, counted
+-- with perf on the backend that runs the query.
+--
+-- Usage (on the database host; needs perf and permission to attach to the
+-- postgres backend, e.g. run as the postgres user with
+-- kernel.perf_event_paranoid <= 1):
+--   psql -d DATABASE -v rows=10000000 -f bench/perf_per_row.sql
+--   psql -d DATABASE -v profile=wide -f bench/perf_per_row.sql   # bench_workload_wide
+--
+-- Each query is a count() over the table, so rows are not sent to the
+-- client. The baseline counts the same column without a conversion; the
+-- "net" column is what each function adds per row (fmgr call included).
+
+\set ON_ERROR_STOP on
+\if :{?rows}
+\else
+\set rows 10000000
+\endif
+
+CREATE EXTENSION IF NOT EXISTS pg_ethiopian_calendar;
+
+DROP TABLE IF EXISTS bench_perf;
+
+\if :{?profile}
+\set source bench_workload_ :profile
+CREATE TABLE bench_perf AS SELECT ts FROM :source;
+\else
+CREATE TABLE bench_perf AS
+SELECT timestamp '1950-01-01' + random() * interval '100 years' AS ts
+FROM generate_series(1, :rows);
+\endif
+
+VACUUM ANALYZE bench_perf;
+
+-- Keep all work in this backend, where perf is attached
+SET max_parallel_workers_per_gather = 0;
+SET jit = off;
+
+SELECT pg_backend_pid() AS pid, count(*) AS nrows FROM bench_perf \gset
+\setenv BENCH_PID :pid
+\setenv BENCH_ROWS :nrows
+\setenv BENCH_OUT /tmp/ethiopian_perf_:pid
+
+\echo 'query                          instructions/row   net/row   cycles/row'
+
+\set label baseline
+\set query 'SELECT count(ts) FROM bench_perf'
+\ir perf_measure.psql
+
+\set label to_ethiopian_date
+\set query 'SELECT count(to_ethiopian_date(ts)) FROM bench_perf'
+\ir perf_measure.psql
+
+\set label to_ethiopian_timestamp
+\set query 'SELECT count(to_ethiopian_timestamp(ts)) FROM bench_perf'
+\ir perf_measure.psql
+
+\set label ethiopian_month
+\set query 'SELECT count(ethiopian_month(ts)) FROM bench_perf'
+\ir perf_measure.psql
+
+\set label from_ethiopian_date
+\set query 'SELECT count(from_ethiopian_date(to_ethiopian_date_text(ts))) FROM bench_perf'
+\ir perf_measure.psql
+
+DROP TABLE bench_perf;
+\! rm -f "$BENCH_OUT".*
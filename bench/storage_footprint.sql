@@ -0,0 +1,120 @@
+-- Benchmark: on-disk and buffer footprint of the ways to store an Ethiopian
+-- date column, built from the same rows.
+--
+-- Usage:
+--   psql -d DATABASE -q -v rows=10000000 -f bench/storage_footprint.sql
+--   psql -d DATABASE -q -v rows=100000000 -v out=/tmp/footprint.csv -f bench/storage_footprint.sql
+--   psql -d DATABASE -q -v profile=recent -f bench/storage_footprint.sql   # bench_workload_recent
+--
+-- Representations (column v of bench_storage_<label>):
+--   gregorian   the source timestamp itself, queried through from_ethiopian_date()
+--   text        to_ethiopian_date(ts), text under the database collation
+--   text_c      to_ethiopian_date_text(ts), the "C"-collated domain
+--   timestamp   to_ethiopian_timestamp(ts)
+--   date        to_ethiopian_timestamp(ts)::date, Ethiopian fields in a 4-byte date
+--   packed_int  year * 10000 + month * 100 + day as integer (20160423)
+--
+-- For each one it records the heap size, B-tree size with and without
+-- deduplication, BRIN size, the time to VACUUM after deleting every tenth
+-- row, and shared buffer hits/reads of a half-year range scan through the
+-- B-tree and through BRIN. The results are written as CSV (one row per
+-- representation) to stdout, or to the file given with -v out=...
+--
+-- Without a profile, rows arrive in roughly chronological order (as in an
+-- append-only event table), which is what BRIN needs. The range scans
+-- cover Ethiopian 2016-01-01 to 2016-06-30, away from Pagumē so every
+-- representation can express the range as a plain interval.
+
+\set ON_ERROR_STOP on
+\if :{?rows}
+\else
+\set rows 10000000
+\endif
+
+CREATE EXTENSION IF NOT EXISTS pg_ethiopian_calendar;
+
+DROP TABLE IF EXISTS bench_storage_source;
+
+\if :{?profile}
+\set source bench_workload_ :profile
+CREATE TABLE bench_storage_source AS SELECT id, ts FROM :source;
+\else
+CREATE TABLE bench_storage_source AS
+SELECT id, timestamp '1990-01-01' + (id + random() * 1000) * (interval '40 years' / :rows) AS ts
+FROM generate_series(1, :rows) id;
+\endif
+
+CREATE TEMP TABLE bench_storage_results (
+    representation text,
+    rows bigint,
+    avg_value_bytes numeric,
+    heap_bytes bigint,
+    btree_bytes bigint,
+    btree_nodedup_bytes bigint,
+    brin_bytes bigint,
+    vacuum_ms numeric,
+    btree_scan_rows bigint,
+    btree_shared_hit bigint,
+    btree_shared_read bigint,
+    btree_hit_ratio numeric,
+    brin_scan_rows bigint,
+    brin_shared_hit bigint,
+    brin_shared_read bigint,
+    brin_hit_ratio numeric
+);
+
+-- Rows and shared buffer counts of one execution, from EXPLAIN (ANALYZE, BUFFERS)
+CREATE FUNCTION pg_temp.scan_buffers(query text, OUT scan_rows bigint, OUT shared_hit bigint, OUT shared_read bigint)
+LANGUAGE plpgsql AS $$
+DECLARE
+    plan json;
+BEGIN
+    EXECUTE 'EXPLAIN (ANALYZE, BUFFERS, TIMING OFF, FORMAT JSON) ' || query INTO plan;
+    scan_rows := (plan -> 0 -> 'Plan' ->> 'Actual Rows')::bigint;
+    shared_hit := (plan -> 0 -> 'Plan' ->> 'Shared Hit Blocks')::bigint;
+    shared_read := (plan -> 0 -> 'Plan' ->> 'Shared Read Blocks')::bigint;
+END
+$$;
+
+SET max_parallel_workers_per_gather = 0;
+SET max_parallel_maintenance_workers = 0;
+SET maintenance_work_mem = '1GB';
+SET jit = off;
+
+\set label gregorian
+\set expr 'ts'
+\set range 'v >= from_ethiopian_date(''2016-01-01'') AND v < from_ethiopian_date(''2016-07-01'')'
+\ir storage_measure.psql
+
+\set label text
+\set expr 'to_ethiopian_date(ts)'
+\set range 'v BETWEEN ''2016-01-01'' AND ''2016-06-30'''
+\ir storage_measure.psql
+
+\set label text_c
+\set expr 'to_ethiopian_date_text(ts)'
+\set range 'v BETWEEN ''2016-01-01'' AND ''2016-06-30'''
+\ir storage_measure.psql
+
+\set label timestamp
+\set expr 'to_ethiopian_timestamp(ts)'
+\set range 'v >= ''2016-01-01'' AND v < ''2016-07-01'''
+\ir storage_measure.psql
+
+\set label date
+\set expr 'to_ethiopian_timestamp(ts)::date'
+\set range 'v BETWEEN ''2016-01-01'' AND ''2016-06-30'''
+\ir storage_measure.psql
+
+\set label packed_int
+\set expr '(ethiopian_year(ts) * 10000 + ethiopian_month(ts) * 100 + ethiopian_day(ts))'
+\set range 'v BETWEEN 20160101 AND 20160630'
+\ir storage_measure.psql
+
+\if :{?out}
+\o :out
+\endif
+COPY (SELECT * FROM bench_storage_results) TO STDOUT WITH (FORMAT csv, HEADER);
+\o
+
+DROP TABLE bench_storage_source;
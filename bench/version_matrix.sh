@@ -0,0 +1,94 @@
+#!/bin/bash
+# Runs the conversion workloads on every supported PostgreSQL major and
+# prints a comparison table.
+#
+# For each version, builds the extension image from the repository
+# Dockerfile (--build-arg PG_VERSION), starts a throwaway container, runs
+# bench/version_workload.sql inside it and removes the container. Results are
+# collected in $OUT_DIR/results.csv. The table compares ns/row and the ratio
+# to the built-in to_char() for each workload and mode. It flags any version
+# that is more than THRESHOLD percent slower than the first one, and any
+# parallel run that launched no workers.
+#
+# Usage:
+#   bench/version_matrix.sh                          # 14 15 16 17, 1M rows
+#   VERSIONS="16 17" ROWS=5000000 RUNS=5 bench/version_matrix.sh
+#   OUT_DIR=/tmp/matrix THRESHOLD=5 bench/version_matrix.sh
+#
+# Needs docker. Every container gets the same settings (SHARED_BUFFERS,
+# --cpus CPUS), so only the major version differs.
+
+set -euo pipefail
+
+VERSIONS="${VERSIONS:-14 15 16 17}"
+ROWS="${ROWS:-1000000}"
+RUNS="${RUNS:-3}"
+THRESHOLD="${THRESHOLD:-10}"
+CPUS="${CPUS:-4}"
+SHARED_BUFFERS="${SHARED_BUFFERS:-512MB}"
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+OUT_DIR="${OUT_DIR:-${TMPDIR:-/tmp}/ethiopian_version_matrix}"
+RESULTS="$OUT_DIR/results.csv"
+CONTAINER="ethiopian_calendar_bench_$$"
+
+mkdir -p "$OUT_DIR"
+echo "pg_version,workload,mode,rows,best_ms,ns_per_row,vs_builtin,workers_launched,jit_functions,jit_inlining" > "$RESULTS"
+trap 'docker rm -f "$CONTAINER" >/dev/null 2>&1 || true' EXIT
+
+for version in $VERSIONS; do
+    image="pg-ethiopian-calendar-bench:${version}"
+    echo "== PostgreSQL ${version}: building ${image}" >&2
+    docker build -q --build-arg PG_VERSION="$version" -t "$image" "$ROOT" >/dev/null
+
+    docker run -d --name "$CONTAINER" --cpus "$CPUS" \
+        -e POSTGRES_HOST_AUTH_METHOD=trust "$image" \
+        -c shared_buffers="$SHARED_BUFFERS" -c max_worker_processes=8 \
+        -c max_parallel_workers=8 >/dev/null
+
+    # The entrypoint restarts the server once after initdb, so wait for a
+    # query to succeed rather than for the first pg_isready
+    for _ in $(seq 60); do
+        if docker exec "$CONTAINER" psql -U postgres -X -q -c 'SELECT 1' >/dev/null 2>&1; then
+            break
+        fi
+        sleep 1
+    done
+
+    echo "== PostgreSQL ${version}: running workloads (${ROWS} rows, best of ${RUNS})" >&2
+    docker exec -i "$CONTAINER" psql -U postgres -X -q -v ON_ERROR_STOP=1 \
+        -v rows="$ROWS" -v runs="$RUNS" -f - < "$ROOT/bench/version_workload.sql" >> "$RESULTS"
+
+    docker rm -f "$CONTAINER" >/dev/null
+done
+
+echo "Results: $RESULTS" >&2
+
+# One line per workload and mode, one column per version: ns/row (x to_char)
+awk -F, -v threshold="$THRESHOLD" -v versions="$VERSIONS" '
+NR == 1 { next }
+{
+    key = $2 "/" $3
+    if (!(key in seen)) { seen[key] = 1; keys[++nkeys] = key }
+    ns[key, $1] = $6
+    cell[key, $1] = sprintf("%.1f (x%s)", $6, $7)
+    if ($3 == "parallel" && $8 == 0 && $2 != "builtin_to_char") serial[key] = 1
+}
+END {
+    n = split(versions, v, " ")
+    printf "%-34s", "workload/mode"
+    for (i = 1; i <= n; i++) printf " %18s", "PG " v[i]
+    printf "  notes\n"
+    for (k = 1; k <= nkeys; k++) {
+        key = keys[k]
+        notes = ""
+        printf "%-34s", key
+        for (i = 1; i <= n; i++) {
+            printf " %18s", ((key, v[i]) in cell) ? cell[key, v[i]] : "-"
+            if (i > 1 && ns[key, v[1]] > 0 && ns[key, v[i]] > ns[key, v[1]] * (1 + threshold / 100))
+                notes = notes sprintf(" PG%s +%.0f%%", v[i], (ns[key, v[i]] / ns[key, v[1]] - 1) * 100)
+        }
+        if (key in serial) notes = notes " no parallel workers"
+        printf "  %s\n", notes
+    }
+    printf "\nns/row (xN = time relative to to_char() in the same mode); notes flag versions more than %s%% slower than PG %s\n", threshold, v[1]
+}' "$RESULTS"
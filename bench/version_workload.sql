@@ -0,0 +1,108 @@
+-- Conversion workloads for bench/version_matrix.sh, run once per
+-- PostgreSQL major. Can also be run on its own:
+--   psql -d DATABASE -q -v rows=1000000 -v runs=3 -f bench/version_workload.sql
+--
+-- Every workload runs in three modes:
+--   serial    jit = off, no parallel workers
+--   jit       JIT forced on for every query (compile, inline and optimize)
+--   parallel  parallel workers made as cheap as possible; workers_launched
+--             stays 0 when a function in the query is not PARALLEL SAFE
+-- and keeps the best of :runs executions, timed by EXPLAIN (ANALYZE,
+-- TIMING OFF). Output is CSV on stdout, one row per workload and mode:
+--   pg_version,workload,mode,rows,best_ms,ns_per_row,vs_builtin,
+--   workers_launched,jit_functions,jit_inlining
+-- vs_builtin divides by to_char() in the same mode, which factors out how
+-- fast the server and the major version are in general.
+
+\set ON_ERROR_STOP on
+\if :{?rows}
+\else
+\set rows 1000000
+\endif
+\if :{?runs}
+\else
+\set runs 3
+\endif
+
+CREATE EXTENSION IF NOT EXISTS pg_ethiopian_calendar;
+
+DROP TABLE IF EXISTS bench_versions;
+CREATE TABLE bench_versions AS
+SELECT ts, to_ethiopian_date(ts) AS eth_date
+FROM (
+    SELECT timestamp '1950-01-01' + random() * interval '100 years' AS ts
+    FROM generate_series(1, :rows)
+) s;
+VACUUM ANALYZE bench_versions;
+
+CREATE TEMP TABLE bench_version_results (
+    workload text,
+    mode text,
+    best_ms numeric,
+    workers_launched int,
+    jit_functions int,
+    jit_inlining boolean
+);
+
+-- Best of runs executions of query under mode; the settings only last for the call
+CREATE FUNCTION pg_temp.bench_query(workload text, mode text, query text, runs int)
+RETURNS void
+LANGUAGE plpgsql AS $$
+DECLARE
+    plan jsonb;
+    best numeric;
+    best_plan jsonb;
+    i int;
+BEGIN
+    PERFORM set_config('jit', (mode = 'jit')::text, true);
+    PERFORM set_config('jit_above_cost', '0', true);
+    PERFORM set_config('jit_inline_above_cost', '0', true);
+    PERFORM set_config('jit_optimize_above_cost', '0', true);
+    PERFORM set_config('max_parallel_workers_per_gather', CASE WHEN mode = 'parallel' THEN '4' ELSE '0' END, true);
+    PERFORM set_config('parallel_setup_cost', '0', true);
+    PERFORM set_config('parallel_tuple_cost', '0', true);
+    PERFORM set_config('min_parallel_table_scan_size', '0', true);
+
+    -- Warm-up: caches, and the first JIT compilation in this backend
+    EXECUTE query;
+
+    FOR i IN 1 .. runs LOOP
+        EXECUTE 'EXPLAIN (ANALYZE, TIMING OFF, FORMAT JSON) ' || query INTO plan;
+        IF best IS NULL OR (plan -> 0 ->> 'Execution Time')::numeric < best THEN
+            best := (plan -> 0 ->> 'Execution Time')::numeric;
+            best_plan := plan -> 0;
+        END IF;
+    END LOOP;
+
+    INSERT INTO bench_version_results
+    VALUES (workload, mode, round(best, 3),
+            coalesce((SELECT sum(w::int) FROM jsonb_path_query(best_plan, 'strict $.**."Workers Launched"') w), 0),
+            coalesce((best_plan -> 'JIT' ->> 'Functions')::int, 0),
+            coalesce((best_plan -> 'JIT' -> 'Options' ->> 'Inlining')::boolean, false));
+END
+$$;
+
+SELECT pg_temp.bench_query(w.workload, m.mode, w.query, :runs)
+FROM (VALUES
+    ('builtin_to_char',        'SELECT count(to_char(ts, ''YYYY-MM-DD'')) FROM bench_versions'),
+    ('to_ethiopian_date',      'SELECT count(to_ethiopian_date(ts)) FROM bench_versions'),
+    ('to_ethiopian_timestamp', 'SELECT count(to_ethiopian_timestamp(ts)) FROM bench_versions'),
+    ('ethiopian_month',        'SELECT count(ethiopian_month(ts)) FROM bench_versions'),
+    ('ethiopian_date_part',    'SELECT count(ethiopian_date_part(''doy'', ts)) FROM bench_versions'),
+    ('from_ethiopian_date',    'SELECT count(from_ethiopian_date(eth_date)) FROM bench_versions'),
+    ('filter_eth_year',        'SELECT count(*) FROM bench_versions WHERE ethiopian_year(ts) = 2016')
+) AS w(workload, query)
+CROSS JOIN (VALUES ('serial'), ('jit'), ('parallel')) AS m(mode);
+
+COPY (
+    SELECT current_setting('server_version_num')::int / 10000 AS pg_version,
+           r.workload, r.mode, :rows AS rows, r.best_ms,
+           round(r.best_ms * 1000000 / :rows, 1) AS ns_per_row,
+           round(r.best_ms / nullif(b.best_ms, 0), 2) AS vs_builtin,
+           r.workers_launched, r.jit_functions, r.jit_inlining
+    FROM bench_version_results r
+    JOIN bench_version_results b ON b.workload = 'builtin_to_char' AND b.mode = r.mode
+    ORDER BY r.workload, r.mode
+) TO STDOUT WITH (FORMAT csv);
+
+DROP TABLE bench_versions;
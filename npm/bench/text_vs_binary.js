@@ -0,0 +1,58 @@
+#!/usr/bin/env node
+/**
+ * Fetches Ethiopian dates and timestamps through node-postgres as text and
+ * as binary, and reports the time per mode.
+ *
+ * @example
+ *   npm run build && npm install --no-save pg
+ *   DATABASE_URL=postgres://postgres@localhost/postgres node bench/text_vs_binary.js 1000000
+ */
+
+const { Client, types } = require("pg");
+const { ethiopianTypes } = require("../dist/pg");
+
+const rows = Number(process.argv[2] || 1000000);
+
+const QUERY = `
+  SELECT to_ethiopian_timestamp(ts) AS eth_ts, to_ethiopian_date(ts) AS eth_date
+  FROM generate_series(1, $1::int) g,
+       LATERAL (SELECT '2000-01-01'::timestamp + g * interval '1 minute') s(ts)`;
+
+const MODES = [
+  // pg defaults: timestamps become (wrong) JS Dates, dates stay strings
+  { name: "text, pg default parsers", binary: false, types: undefined },
+  { name: "text, ethiopianTypes()", binary: false, types: ethiopianTypes({}, types) },
+  { name: "binary, ethiopianTypes()", binary: true, types: ethiopianTypes({}, types) },
+];
+
+async function run(client, mode) {
+  const started = process.hrtime.bigint();
+  const result = await client.query({ text: QUERY, values: [rows], binary: mode.binary, types: mode.types });
+  const ms = Number(process.hrtime.bigint() - started) / 1e6;
+
+  if (result.rows.length !== rows) throw new Error(`expected ${rows} rows, got ${result.rows.length}`);
+  return ms;
+}
+
+async function main() {
+  const client = new Client({ connectionString: process.env.DATABASE_URL });
+  await client.connect();
+
+  try {
+    console.log(`rows: ${rows}`);
+    for (const mode of MODES) {
+      await run(client, mode); // warm-up
+      const times = [];
+      for (let i = 0; i < 3; i++) times.push(await run(client, mode));
+      const best = Math.min(...times);
+      console.log(`${mode.name.padEnd(28)} ${best.toFixed(0).padStart(7)} ms  ${Math.round(rows / (best / 1000)).toLocaleString()} rows/s`);
+    }
+  } finally {
+    await client.end();
+  }
+}
+
+main().catch((err) => {
+  console.error(err.message);
+  process.exit(1);
+});
@@ -0,0 +1,11 @@
+{
+  "targets": [
+    {
+      "target_name": "ethiopian_calendar",
+      "sources": ["ethiopian_calendar.c"],
+      "include_dirs": [".", "../../src"],
+      "cflags": ["-O2"],
+      "xcode_settings": { "OTHER_CFLAGS": ["-O2"] }
+    }
+  ]
+}
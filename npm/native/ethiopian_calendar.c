@@ -0,0 +1,348 @@
+/*
+ * ethiopian_calendar.c
+ *
+ * Node.js native addon (N-API) exposing the Ethiopian calendar kernels of the
+ * PostgreSQL extension, for converting dates in-process.
+ *
+ * The conversions come from ../../src/ethiopian_core.h (copied next to this
+ * file when the package is packed), and parsing, validation and error
+ * messages follow the SQL functions in src/ethiopian_calendar.c, so results
+ * match to_ethiopian_date() and from_ethiopian_date() exactly.
+ *
+ * Dates are passed as Unix day numbers (days since 1970-01-01, UTC), i.e.
+ * Math.floor(date.getTime() / 86400000).
+ */
+
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <node_api.h>
+
+#include "ethiopian_core.h"
+
+/* Julian Day Number of 1970-01-01 */
+#define UNIX_EPOCH_JDN 2440588
+
+/* Last Julian Day Number accepted, same as PostgreSQL's DATE_END_JULIAN */
+#define END_JDN 2147483494
+
+/* Marks an invalid element in fromEthiopianParts() output */
+#define INVALID_DAY INT32_MIN
+
+#define NAPI_CALL(env, call) \
+    do { \
+        if ((call) != napi_ok) \
+        { \
+            napi_throw_error((env), NULL, "N-API call failed: " #call); \
+            return NULL; \
+        } \
+    } while (0)
+
+/*
+ * Convert a Unix day number to a JDN
+ *
+ * Returns: 1 on success, 0 (with a pending RangeError) if the date is before
+ * the Ethiopian epoch or out of range
+ */
+static int
+unix_day_to_jdn(napi_env env, double unix_day, int *jdn)
+{
+    double value;
+
+    if (!isfinite(unix_day))
+    {
+        napi_throw_range_error(env, NULL, "date must be a finite number of days");
+        return 0;
+    }
+
+    value = floor(unix_day) + UNIX_EPOCH_JDN;
+    if (value < ETHIOPIAN_EPOCH)
+    {
+        napi_throw_range_error(env, NULL, "date is before Ethiopian calendar epoch (August 29, 8 CE)");
+        return 0;
+    }
+    if (value >= END_JDN)
+    {
+        napi_throw_range_error(env, NULL, "date out of range");
+        return 0;
+    }
+
+    *jdn = (int) value;
+    return 1;
+}
+
+/*
+ * Fetch an Int32Array argument
+ */
+static int
+get_int32_array(napi_env env, napi_value value, const char *name, int32_t **data, size_t *length)
+{
+    bool is_typedarray;
+    napi_typedarray_type type;
+    void *raw;
+
+    if (napi_is_typedarray(env, value, &is_typedarray) != napi_ok || !is_typedarray ||
+        napi_get_typedarray_info(env, value, &type, length, &raw, NULL, NULL) != napi_ok ||
+        type != napi_int32_array)
+    {
+        char message[64];
+
+        snprintf(message, sizeof(message), "%s must be an Int32Array", name);
+        napi_throw_type_error(env, NULL, message);
+        return 0;
+    }
+
+    *data = (int32_t *) raw;
+    return 1;
+}
+
+/*
+ * toEthiopianDate(unixDay: number): string
+ *
+ * Same result as to_ethiopian_date(): "YYYY-MM-DD" (Ethiopian calendar).
+ */
+static napi_value
+to_ethiopian_date(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1];
+    napi_value result;
+    double unix_day;
+    int jdn;
+    int year, month, day;
+    char buf[32];
+
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+    if (argc < 1 || napi_get_value_double(env, argv[0], &unix_day) != napi_ok)
+    {
+        napi_throw_type_error(env, NULL, "date must be a number of days since 1970-01-01");
+        return NULL;
+    }
+
+    if (!unix_day_to_jdn(env, unix_day, &jdn))
+        return NULL;
+
+    jdn_to_ethiopian(jdn, &year, &month, &day);
+    snprintf(buf, sizeof(buf), "%04d-%02d-%02d", year, month, day);
+
+    NAPI_CALL(env, napi_create_string_utf8(env, buf, NAPI_AUTO_LENGTH, &result));
+    return result;
+}
+
+/*
+ * fromEthiopianDate(text: string): number
+ *
+ * Same parsing and validation as from_ethiopian_date(); returns the Unix day
+ * number of the Gregorian date.
+ */
+static napi_value
+from_ethiopian_date(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value argv[1];
+    napi_value result;
+    size_t length;
+    char stack_buf[64];
+    char *date_str;
+    char message[160];
+    int eth_year, eth_month, eth_day;
+    int parsed;
+
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+    if (argc < 1 || napi_get_value_string_utf8(env, argv[0], NULL, 0, &length) != napi_ok)
+    {
+        napi_throw_type_error(env, NULL, "Ethiopian date must be a string");
+        return NULL;
+    }
+
+    date_str = length < sizeof(stack_buf) ? stack_buf : malloc(length + 1);
+    if (date_str == NULL)
+    {
+        napi_throw_error(env, NULL, "out of memory");
+        return NULL;
+    }
+    napi_get_value_string_utf8(env, argv[0], date_str, length + 1, &length);
+
+    parsed = sscanf(date_str, "%d-%d-%d", &eth_year, &eth_month, &eth_day);
+    if (parsed != 3)
+        snprintf(message, sizeof(message), "invalid Ethiopian date format: %.64s (expected YYYY-MM-DD)", date_str);
+    if (date_str != stack_buf)
+        free(date_str);
+    if (parsed != 3)
+    {
+        napi_throw_error(env, NULL, message);
+        return NULL;
+    }
+
+    if (eth_month < 1 || eth_month > 13)
+    {
+        snprintf(message, sizeof(message), "invalid Ethiopian month: %d (must be 1-13)", eth_month);
+        napi_throw_range_error(env, NULL, message);
+        return NULL;
+    }
+    if (eth_day < 1)
+    {
+        snprintf(message, sizeof(message), "invalid Ethiopian day: %d (must be >= 1)", eth_day);
+        napi_throw_range_error(env, NULL, message);
+        return NULL;
+    }
+    if (eth_month <= 12 && eth_day > 30)
+    {
+        snprintf(message, sizeof(message), "invalid Ethiopian day: %d (month %d has 30 days)", eth_day, eth_month);
+        napi_throw_range_error(env, NULL, message);
+        return NULL;
+    }
+    if (eth_month == 13)
+    {
+        int max_days = (eth_year % 4 == 3) ? 6 : 5;
+
+        if (eth_day > max_days)
+        {
+            snprintf(message, sizeof(message), "invalid Ethiopian day: %d (month 13 has %d days in year %d)",
+                     eth_day, max_days, eth_year);
+            napi_throw_range_error(env, NULL, message);
+            return NULL;
+        }
+    }
+
+    NAPI_CALL(env, napi_create_double(env,
+                                      (double) ethiopian_to_jdn(eth_year, eth_month, eth_day) - UNIX_EPOCH_JDN,
+                                      &result));
+    return result;
+}
+
+/*
+ * toEthiopianParts(unixDays, years, months, days: Int32Array): number
+ *
+ * Batch conversion into caller-provided arrays of the same length. Dates
+ * before the Ethiopian epoch or at or after END_JDN (the same range
+ * toEthiopianDate() accepts) get 0/0/0. Returns the number of such elements.
+ */
+static napi_value
+to_ethiopian_parts(napi_env env, napi_callback_info info)
+{
+    size_t argc = 4;
+    napi_value argv[4];
+    napi_value result;
+    int32_t *unix_days, *years, *months, *days;
+    size_t n, n_years, n_months, n_days;
+    size_t i;
+    int32_t invalid = 0;
+
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+    if (argc < 4)
+    {
+        napi_throw_type_error(env, NULL, "expected (unixDays, years, months, days)");
+        return NULL;
+    }
+    if (!get_int32_array(env, argv[0], "unixDays", &unix_days, &n) ||
+        !get_int32_array(env, argv[1], "years", &years, &n_years) ||
+        !get_int32_array(env, argv[2], "months", &months, &n_months) ||
+        !get_int32_array(env, argv[3], "days", &days, &n_days))
+        return NULL;
+    if (n_years < n || n_months < n || n_days < n)
+    {
+        napi_throw_range_error(env, NULL, "output arrays must be at least as long as unixDays");
+        return NULL;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        /* The largest Int32 day numbers pass END_JDN and would wrap in (int) jdn */
+        int64_t jdn = (int64_t) unix_days[i] + UNIX_EPOCH_JDN;
+
+        if (jdn < ETHIOPIAN_EPOCH || jdn >= END_JDN)
+        {
+            years[i] = months[i] = days[i] = 0;
+            invalid++;
+            continue;
+        }
+        jdn_to_ethiopian((int) jdn, &years[i], &months[i], &days[i]);
+    }
+
+    NAPI_CALL(env, napi_create_int32(env, invalid, &result));
+    return result;
+}
+
+/*
+ * fromEthiopianParts(years, months, days, unixDays: Int32Array): number
+ *
+ * Batch conversion of Ethiopian dates into Unix day numbers. Invalid dates
+ * (same rules as from_ethiopian_date(), plus year >= 1) get -2147483648.
+ * Returns the number of such elements.
+ */
+static napi_value
+from_ethiopian_parts(napi_env env, napi_callback_info info)
+{
+    size_t argc = 4;
+    napi_value argv[4];
+    napi_value result;
+    int32_t *years, *months, *days, *unix_days;
+    size_t n, n_months, n_days, n_out;
+    size_t i;
+    int32_t invalid = 0;
+
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+    if (argc < 4)
+    {
+        napi_throw_type_error(env, NULL, "expected (years, months, days, unixDays)");
+        return NULL;
+    }
+    if (!get_int32_array(env, argv[0], "years", &years, &n) ||
+        !get_int32_array(env, argv[1], "months", &months, &n_months) ||
+        !get_int32_array(env, argv[2], "days", &days, &n_days) ||
+        !get_int32_array(env, argv[3], "unixDays", &unix_days, &n_out))
+        return NULL;
+    if (n_months < n || n_days < n || n_out < n)
+    {
+        napi_throw_range_error(env, NULL, "months, days and unixDays must be at least as long as years");
+        return NULL;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        int64_t jdn;
+
+        if (!ethiopian_date_is_valid(years[i], months[i], days[i]))
+        {
+            unix_days[i] = INVALID_DAY;
+            invalid++;
+            continue;
+        }
+
+        /* Same arithmetic as ethiopian_to_jdn(), in 64 bits to catch huge years */
+        jdn = (int64_t) ETHIOPIAN_EPOCH + (int64_t) ((years[i] - 1) / 4) * 1461 +
+            ((years[i] - 1) % 4) * 365 + (months[i] - 1) * 30 + (days[i] - 1);
+        if (jdn - UNIX_EPOCH_JDN > INT32_MAX)
+        {
+            unix_days[i] = INVALID_DAY;
+            invalid++;
+            continue;
+        }
+        unix_days[i] = (int32_t) (jdn - UNIX_EPOCH_JDN);
+    }
+
+    NAPI_CALL(env, napi_create_int32(env, invalid, &result));
+    return result;
+}
+
+static napi_value
+init(napi_env env, napi_value exports)
+{
+    napi_property_descriptor properties[] = {
+        {"toEthiopianDate", NULL, to_ethiopian_date, NULL, NULL, NULL, napi_default, NULL},
+        {"fromEthiopianDate", NULL, from_ethiopian_date, NULL, NULL, NULL, napi_default, NULL},
+        {"toEthiopianParts", NULL, to_ethiopian_parts, NULL, NULL, NULL, napi_default, NULL},
+        {"fromEthiopianParts", NULL, from_ethiopian_parts, NULL, NULL, NULL, napi_default, NULL},
+    };
+
+    NAPI_CALL(env, napi_define_properties(env, exports,
+                                          sizeof(properties) / sizeof(properties[0]),
+                                          properties));
+    return exports;
+}
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, init)
@@ -14,6 +14,14 @@ AS $$
     SELECT '1.1.3'::text;
 $$;
 
+CREATE OR REPLACE FUNCTION ethiopian_calendar_implementation()
+RETURNS text
+LANGUAGE sql
+IMMUTABLE
+AS $$
+    SELECT 'plpgsql'::text;
+$$;
+
 CREATE OR REPLACE FUNCTION _gregorian_to_jdn(g_year integer, g_month integer, g_day integer)
 RETURNS integer
 LANGUAGE plpgsql
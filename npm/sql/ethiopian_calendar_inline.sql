@@ -0,0 +1,289 @@
+-- Ethiopian Calendar Functions for PostgreSQL (Inlinable SQL)
+-- Same functions and results as ethiopian_calendar.sql, written as
+-- single-expression LANGUAGE sql functions. The planner inlines them into the
+-- calling query, so converting a row costs a few integer operations instead
+-- of a PL/pgSQL call. Use this where the C extension cannot be installed.
+--
+-- The helpers are deliberately not STRICT (a STRICT SQL function is only
+-- inlined if its body is provably strict); NULL input still gives NULL.
+-- Error paths call small PL/pgSQL functions inside CASE branches that are
+-- only reached for invalid input.
+--
+-- Author: Hulunlante Worku <hulunlante.w@gmail.com>
+-- License: PostgreSQL License
+-- Repository: https://github.com/HuluWZ/pg-ethiopian-calendar
+
+CREATE OR REPLACE FUNCTION ethiopian_calendar_version()
+RETURNS text
+LANGUAGE sql
+IMMUTABLE
+AS $$
+    SELECT '1.1.3'::text;
+$$;
+
+CREATE OR REPLACE FUNCTION ethiopian_calendar_implementation()
+RETURNS text
+LANGUAGE sql
+IMMUTABLE
+AS $$
+    SELECT 'sql-inline'::text;
+$$;
+
+-- Days since the Ethiopian epoch (JDN 1724221) of the date part of ts
+CREATE OR REPLACE FUNCTION _ethiopian_epoch_days(ts timestamp)
+RETURNS integer
+LANGUAGE sql
+IMMUTABLE
+AS $$
+    SELECT ts::date - DATE '2000-01-01' + 727324;
+$$;
+
+CREATE OR REPLACE FUNCTION _ethiopian_year(days integer)
+RETURNS integer
+LANGUAGE sql
+IMMUTABLE
+AS $$
+    SELECT 4 * (days / 1461) + least(days % 1461 / 365, 3) + 1;
+$$;
+
+-- 0-based day of the Ethiopian year (365 only on the last day of a 4-year cycle)
+CREATE OR REPLACE FUNCTION _ethiopian_day_of_year(days integer)
+RETURNS integer
+LANGUAGE sql
+IMMUTABLE
+AS $$
+    SELECT days % 1461 - 365 * least(days % 1461 / 365, 3);
+$$;
+
+CREATE OR REPLACE FUNCTION _ethiopian_month(days integer)
+RETURNS integer
+LANGUAGE sql
+IMMUTABLE
+AS $$
+    SELECT least(_ethiopian_day_of_year(days) / 30 + 1, 13);
+$$;
+
+CREATE OR REPLACE FUNCTION _ethiopian_day(days integer)
+RETURNS integer
+LANGUAGE sql
+IMMUTABLE
+AS $$
+    SELECT CASE WHEN _ethiopian_day_of_year(days) < 360
+                THEN _ethiopian_day_of_year(days) % 30 + 1
+                ELSE least(_ethiopian_day_of_year(days) - 359,
+                           CASE WHEN _ethiopian_year(days) % 4 = 3 THEN 6 ELSE 5 END)
+           END;
+$$;
+
+CREATE OR REPLACE FUNCTION _ethiopian_format(days integer)
+RETURNS text
+LANGUAGE sql
+IMMUTABLE
+AS $$
+    SELECT CASE WHEN _ethiopian_year(days) < 1000
+                THEN lpad(_ethiopian_year(days)::text, 4, '0')
+                ELSE _ethiopian_year(days)::text
+           END
+           || '-' || lpad(_ethiopian_month(days)::text, 2, '0')
+           || '-' || lpad(_ethiopian_day(days)::text, 2, '0');
+$$;
+
+CREATE OR REPLACE FUNCTION _ethiopian_date_valid(e_year integer, e_month integer, e_day integer)
+RETURNS boolean
+LANGUAGE sql
+IMMUTABLE
+AS $$
+    SELECT e_year >= 1 AND e_month BETWEEN 1 AND 13 AND e_day >= 1
+       AND e_day <= CASE WHEN e_month <= 12 THEN 30 WHEN e_year % 4 = 3 THEN 6 ELSE 5 END;
+$$;
+
+-- Gregorian timestamp (midnight) of a validated Ethiopian date
+CREATE OR REPLACE FUNCTION _ethiopian_parts_to_timestamp(e_year integer, e_month integer, e_day integer)
+RETURNS timestamp
+LANGUAGE sql
+IMMUTABLE
+AS $$
+    SELECT (DATE '2000-01-01'
+            + ((e_year - 1) / 4 * 1461 + (e_year - 1) % 4 * 365 + (e_month - 1) * 30 + e_day - 1 - 727324))::timestamp;
+$$;
+
+-- Error path for dates before the epoch; result only carries the return type.
+-- Takes ts so the call is never constant-folded at plan time.
+CREATE OR REPLACE FUNCTION _ethiopian_epoch_error(ts timestamp, result anyelement)
+RETURNS anyelement
+LANGUAGE plpgsql
+IMMUTABLE
+AS $$
+BEGIN
+    RAISE EXCEPTION 'Date % is before Ethiopian calendar epoch (August 29, 8 CE)', ts::date
+        USING ERRCODE = 'datetime_field_overflow';
+END;
+$$;
+
+-- Slow path of from_ethiopian_date(): inputs the fast path does not accept
+-- (signs, inner spaces, invalid dates) are parsed and reported here exactly as
+-- in ethiopian_calendar.sql
+CREATE OR REPLACE FUNCTION _ethiopian_from_date_slow(ethiopian_date text)
+RETURNS timestamp
+LANGUAGE plpgsql
+IMMUTABLE STRICT
+AS $$
+DECLARE
+    parts text[];
+    e_year integer;
+    e_month integer;
+    e_day integer;
+    max_days integer;
+BEGIN
+    IF trim(ethiopian_date) = '' THEN
+        RAISE EXCEPTION 'Ethiopian date cannot be NULL or empty'
+            USING ERRCODE = 'null_value_not_allowed';
+    END IF;
+
+    parts := string_to_array(trim(ethiopian_date), '-');
+
+    IF array_length(parts, 1) IS NULL OR array_length(parts, 1) != 3 THEN
+        RAISE EXCEPTION 'Invalid Ethiopian date format: "%" (expected YYYY-MM-DD)', ethiopian_date
+            USING ERRCODE = 'invalid_datetime_format';
+    END IF;
+
+    BEGIN
+        e_year := parts[1]::integer;
+    EXCEPTION WHEN OTHERS THEN
+        RAISE EXCEPTION 'Invalid Ethiopian year: "%" (must be a number)', parts[1]
+            USING ERRCODE = 'invalid_datetime_format';
+    END;
+
+    BEGIN
+        e_month := parts[2]::integer;
+    EXCEPTION WHEN OTHERS THEN
+        RAISE EXCEPTION 'Invalid Ethiopian month: "%" (must be a number)', parts[2]
+            USING ERRCODE = 'invalid_datetime_format';
+    END;
+
+    BEGIN
+        e_day := parts[3]::integer;
+    EXCEPTION WHEN OTHERS THEN
+        RAISE EXCEPTION 'Invalid Ethiopian day: "%" (must be a number)', parts[3]
+            USING ERRCODE = 'invalid_datetime_format';
+    END;
+
+    IF e_year < 1 THEN
+        RAISE EXCEPTION 'Invalid Ethiopian year: % (must be >= 1)', e_year
+            USING ERRCODE = 'datetime_field_overflow';
+    END IF;
+
+    IF e_month < 1 OR e_month > 13 THEN
+        RAISE EXCEPTION 'Invalid Ethiopian month: % (must be 1-13)', e_month
+            USING ERRCODE = 'datetime_field_overflow';
+    END IF;
+
+    IF e_day < 1 THEN
+        RAISE EXCEPTION 'Invalid Ethiopian day: % (must be >= 1)', e_day
+            USING ERRCODE = 'datetime_field_overflow';
+    END IF;
+
+    IF e_month <= 12 THEN
+        IF e_day > 30 THEN
+            RAISE EXCEPTION 'Invalid Ethiopian day: % (month % has 30 days)', e_day, e_month
+                USING ERRCODE = 'datetime_field_overflow';
+        END IF;
+    ELSE
+        max_days := CASE WHEN e_year % 4 = 3 THEN 6 ELSE 5 END;
+        IF e_day > max_days THEN
+            RAISE EXCEPTION 'Invalid Ethiopian day: % (month 13 has % days in year %)', e_day, max_days, e_year
+                USING ERRCODE = 'datetime_field_overflow';
+        END IF;
+    END IF;
+
+    RETURN _ethiopian_parts_to_timestamp(e_year, e_month, e_day);
+END;
+$$;
+
+CREATE OR REPLACE FUNCTION to_ethiopian_date(ts timestamp)
+RETURNS text
+LANGUAGE sql
+IMMUTABLE
+AS $$
+    SELECT CASE WHEN _ethiopian_epoch_days(ts) < 0
+                THEN _ethiopian_epoch_error(ts, NULL::text)
+                ELSE _ethiopian_format(_ethiopian_epoch_days(ts))
+           END;
+$$;
+
+CREATE OR REPLACE FUNCTION to_ethiopian_date()
+RETURNS text
+LANGUAGE sql
+STABLE
+AS $$
+    SELECT to_ethiopian_date(NOW()::timestamp);
+$$;
+
+CREATE OR REPLACE FUNCTION from_ethiopian_date(ethiopian_date text)
+RETURNS timestamp
+LANGUAGE sql
+IMMUTABLE
+AS $$
+    SELECT CASE WHEN ethiopian_date IS NULL THEN NULL
+                WHEN trim(ethiopian_date) ~ '^[0-9]{1,9}-[0-9]{1,2}-[0-9]{1,2}$'
+                 AND _ethiopian_date_valid(split_part(trim(ethiopian_date), '-', 1)::integer,
+                                           split_part(trim(ethiopian_date), '-', 2)::integer,
+                                           split_part(trim(ethiopian_date), '-', 3)::integer)
+                THEN _ethiopian_parts_to_timestamp(split_part(trim(ethiopian_date), '-', 1)::integer,
+                                                   split_part(trim(ethiopian_date), '-', 2)::integer,
+                                                   split_part(trim(ethiopian_date), '-', 3)::integer)
+                ELSE _ethiopian_from_date_slow(ethiopian_date)
+           END;
+$$;
+
+-- Month 13 (Pagumē) is stored as January of the next year, as in the C extension
+CREATE OR REPLACE FUNCTION to_ethiopian_timestamp(ts timestamp)
+RETURNS timestamp
+LANGUAGE sql
+IMMUTABLE
+AS $$
+    SELECT CASE WHEN _ethiopian_epoch_days(ts) < 0
+                THEN _ethiopian_epoch_error(ts, NULL::timestamp)
+                ELSE make_date(_ethiopian_year(_ethiopian_epoch_days(ts)) + _ethiopian_month(_ethiopian_epoch_days(ts)) / 13,
+                               (_ethiopian_month(_ethiopian_epoch_days(ts)) - 1) % 12 + 1,
+                               _ethiopian_day(_ethiopian_epoch_days(ts)))
+                     + ts::time
+           END;
+$$;
+
+CREATE OR REPLACE FUNCTION to_ethiopian_timestamp()
+RETURNS timestamp
+LANGUAGE sql
+STABLE
+AS $$
+    SELECT to_ethiopian_timestamp(NOW()::timestamp);
+$$;
+
+CREATE OR REPLACE FUNCTION to_ethiopian_datetime(ts timestamp)
+RETURNS timestamp with time zone
+LANGUAGE sql
+IMMUTABLE
+AS $$
+    SELECT to_ethiopian_timestamp(ts)::timestamp with time zone;
+$$;
+
+CREATE OR REPLACE FUNCTION current_ethiopian_date()
+RETURNS text
+LANGUAGE sql
+STABLE
+AS $$
+    SELECT to_ethiopian_date(NOW()::timestamp);
+$$;
+
+-- Aliases with pg_ prefix
+CREATE OR REPLACE FUNCTION pg_ethiopian_to_date(ts timestamp)
+RETURNS text LANGUAGE sql IMMUTABLE AS $$ SELECT to_ethiopian_date(ts); $$;
+
+CREATE OR REPLACE FUNCTION pg_ethiopian_from_date(ethiopian_date text)
+RETURNS timestamp LANGUAGE sql IMMUTABLE AS $$ SELECT from_ethiopian_date(ethiopian_date); $$;
+
+CREATE OR REPLACE FUNCTION pg_ethiopian_to_timestamp(ts timestamp)
+RETURNS timestamp LANGUAGE sql IMMUTABLE AS $$ SELECT to_ethiopian_timestamp(ts); $$;
+
+CREATE OR REPLACE FUNCTION pg_ethiopian_to_datetime(ts timestamp)
+RETURNS timestamp with time zone LANGUAGE sql IMMUTABLE AS $$ SELECT to_ethiopian_datetime(ts); $$;
@@ -2,11 +2,13 @@
 /**
  * CLI for Ethiopian Calendar PostgreSQL migrations
  * @example npx ethiopian-calendar init prisma
+ * @example DATABASE_URL=postgres://... npx ethiopian-calendar install
  */
 
 import { mkdirSync, existsSync, writeFileSync } from "fs";
 import { dirname } from "path";
 import { getSql, detectOrm, getMigrationPath, listMigrations, VERSION, type SupportedORM } from "../index";
+import { install, DROP_FUNCTIONS_SQL, type Implementation } from "../install";
 
 const fmt = {
   reset: "\x1b[0m",
@@ -25,25 +27,6 @@ const print = {
   error: (msg: string) => log(`${fmt.red}✖${fmt.reset} ${msg}`),
 };
 
-const DROP_FUNCTIONS_SQL = `
-DROP FUNCTION IF EXISTS pg_ethiopian_to_datetime(timestamp);
-DROP FUNCTION IF EXISTS pg_ethiopian_to_timestamp(timestamp);
-DROP FUNCTION IF EXISTS pg_ethiopian_from_date(text);
-DROP FUNCTION IF EXISTS pg_ethiopian_to_date(timestamp);
-DROP FUNCTION IF EXISTS ethiopian_calendar_version();
-DROP FUNCTION IF EXISTS current_ethiopian_date();
-DROP FUNCTION IF EXISTS to_ethiopian_datetime(timestamp);
-DROP FUNCTION IF EXISTS to_ethiopian_timestamp();
-DROP FUNCTION IF EXISTS to_ethiopian_timestamp(timestamp);
-DROP FUNCTION IF EXISTS from_ethiopian_date(text);
-DROP FUNCTION IF EXISTS to_ethiopian_date();
-DROP FUNCTION IF EXISTS to_ethiopian_date(timestamp);
-DROP FUNCTION IF EXISTS _ethiopian_to_jdn(integer, integer, integer);
-DROP FUNCTION IF EXISTS _jdn_to_ethiopian(integer);
-DROP FUNCTION IF EXISTS _jdn_to_gregorian(integer);
-DROP FUNCTION IF EXISTS _gregorian_to_jdn(integer, integer, integer);
-`.trim();
-
 function generateTypeOrmMigration(sql: string): string {
   const className = `EthiopianCalendar${Date.now()}`;
   return `import { MigrationInterface, QueryRunner } from "typeorm";
@@ -86,6 +69,7 @@ ${fmt.cyan}${fmt.bold}Ethiopian Calendar for PostgreSQL${fmt.reset} ${fmt.yellow
 
 ${fmt.bold}Usage:${fmt.reset}
   npx ethiopian-calendar init [orm]
+  npx ethiopian-calendar install [--url URL] [--only c-extension|sql-inline|plpgsql]
   npx ethiopian-calendar version
   npx ethiopian-calendar migrations
 
@@ -95,6 +79,7 @@ ${fmt.bold}ORMs:${fmt.reset}
 ${fmt.bold}Examples:${fmt.reset}
   npx ethiopian-calendar init          ${fmt.cyan}# auto-detect${fmt.reset}
   npx ethiopian-calendar init prisma
+  npx ethiopian-calendar install       ${fmt.cyan}# fastest implementation, uses DATABASE_URL${fmt.reset}
 `);
 }
 
@@ -156,6 +141,52 @@ function initMigration(ormArg?: string): void {
   log(`  to_ethiopian_timestamp(ts)   → timestamp\n`);
 }
 
+const IMPLEMENTATIONS: Implementation[] = ["c-extension", "sql-inline", "plpgsql"];
+
+/** Returns the value of --name or --name=value */
+function option(args: string[], name: string): string | undefined {
+  const i = args.findIndex((a) => a === `--${name}` || a.startsWith(`--${name}=`));
+  if (i < 0) return undefined;
+  return args[i].includes("=") ? args[i].slice(args[i].indexOf("=") + 1) : args[i + 1];
+}
+
+async function installDirect(args: string[]): Promise<void> {
+  const url = option(args, "url") ?? process.env.DATABASE_URL;
+  const only = option(args, "only") as Implementation | undefined;
+
+  if (!url) {
+    print.error("No database: set DATABASE_URL or pass --url");
+    process.exit(1);
+  }
+  if (only && !IMPLEMENTATIONS.includes(only)) {
+    print.error(`Unknown implementation: ${only}`);
+    log(`\nSupported: ${IMPLEMENTATIONS.join(", ")}\n`);
+    process.exit(1);
+  }
+
+  let pg: any;
+  try {
+    pg = require("pg");
+  } catch {
+    print.error("install needs the pg package: npm install pg");
+    process.exit(1);
+  }
+
+  const client = new pg.Client({ connectionString: url });
+  try {
+    await client.connect();
+    print.info("Probing database...");
+    const result = await install(client, { only, onProgress: print.info });
+    print.success(`Installed: ${result.implementation} (${Math.round(result.nsPerRow)} ns/row)`);
+    log(`\nCheck database: ${fmt.cyan}SELECT ethiopian_calendar_implementation();${fmt.reset}\n`);
+  } catch (err) {
+    print.error(`Failed: ${err instanceof Error ? err.message : err}`);
+    process.exitCode = 1;
+  } finally {
+    await client.end();
+  }
+}
+
 const [cmd, arg] = process.argv.slice(2);
 
 switch (cmd) {
@@ -176,6 +207,9 @@ switch (cmd) {
   case "init":
     initMigration(arg);
     break;
+  case "install":
+    installDirect(process.argv.slice(3));
+    break;
   default:
     print.error(`Unknown command: ${cmd}`);
     showHelp();
@@ -14,14 +14,25 @@ const ORM_PACKAGES: Record<Exclude<SupportedORM, "raw">, string> = {
 const SQL_DIR = join(dirname(__dirname), "sql");
 const DOCS_DIR = join(dirname(__dirname), "docs");
 
+/**
+ * SQL implementation: "plpgsql" (default) or "inline", single-expression SQL
+ * functions the planner inlines into queries (faster, same results)
+ */
+export type SqlVariant = "plpgsql" | "inline";
+
+const SQL_FILES: Record<SqlVariant, string> = {
+  plpgsql: "ethiopian_calendar.sql",
+  inline: "ethiopian_calendar_inline.sql",
+};
+
 /** Returns the full SQL migration content */
-export function getSql(): string {
-  return readFileSync(join(SQL_DIR, "ethiopian_calendar.sql"), "utf8");
+export function getSql(variant: SqlVariant = "plpgsql"): string {
+  return readFileSync(getSqlPath(variant), "utf8");
 }
 
 /** Returns path to the SQL migration file */
-export function getSqlPath(): string {
-  return join(SQL_DIR, "ethiopian_calendar.sql");
+export function getSqlPath(variant: SqlVariant = "plpgsql"): string {
+  return join(SQL_DIR, SQL_FILES[variant]);
 }
 
 /** Returns path to ORM-specific documentation */
@@ -102,3 +113,36 @@ export function getVersionCheckSql(): string {
     NULL
   )::text AS installed, '${VERSION}' AS latest;`;
 }
+
+export {
+  isNativeAvailable,
+  toEthiopianDate,
+  fromEthiopianDate,
+  fromEthiopianDateToDay,
+  toEthiopianParts,
+  fromEthiopianParts,
+} from "./native";
+export type { EthiopianParts } from "./native";
+
+export {
+  ethiopianTypes,
+  parseEthiopianDate,
+  parseEthiopianTimestampText,
+  parseEthiopianTimestampBinary,
+} from "./pg";
+export type { EthiopianDate, EthiopianDateTime, TypeParserSource } from "./pg";
+
+export {
+  ethiopianDayRange,
+  ethiopianMonthRange,
+  ethiopianYearRange,
+  ethiopianRangeBetween,
+  rangePredicate,
+  inEthiopianMonth,
+  inEthiopianYear,
+  betweenEthiopian,
+} from "./range";
+export type { EthiopianRange, RangePredicate } from "./range";
+
+export { install, probeExtension, benchmark, DROP_FUNCTIONS_SQL } from "./install";
+export type { Implementation, InstallOptions, InstallResult, Candidate, Queryable } from "./install";
@@ -0,0 +1,230 @@
+import { getSql } from "./index";
+
+/**
+ * Installs the fastest Ethiopian calendar implementation a database supports.
+ *
+ * The C extension (pg_ethiopian_calendar) is used when the server offers it
+ * and the role may create it. Otherwise both SQL variants are installed in a
+ * rolled-back transaction, timed with a short built-in benchmark, and the
+ * faster one is kept. Every variant defines ethiopian_calendar_implementation();
+ * the chosen one is also described in that function's comment.
+ */
+
+export type Implementation = "c-extension" | "sql-inline" | "plpgsql";
+
+/** Structural subset of a node-postgres Client */
+export interface Queryable {
+  query(text: string, values?: unknown[]): Promise<{ rows: any[] }>;
+}
+
+export interface Candidate {
+  implementation: Implementation;
+  /** Benchmark result, absent if the candidate could not be installed */
+  nsPerRow?: number;
+  error?: string;
+}
+
+export interface InstallResult {
+  implementation: Implementation;
+  nsPerRow: number;
+  candidates: Candidate[];
+}
+
+export interface InstallOptions {
+  /** Only try this implementation */
+  only?: Implementation;
+  /** Rows per benchmark run (default 100000) */
+  benchmarkRows?: number;
+  /** Called with a progress message per step */
+  onProgress?: (message: string) => void;
+}
+
+/** Drops every function created by the SQL variants */
+export const DROP_FUNCTIONS_SQL = `
+DROP FUNCTION IF EXISTS pg_ethiopian_to_datetime(timestamp);
+DROP FUNCTION IF EXISTS pg_ethiopian_to_timestamp(timestamp);
+DROP FUNCTION IF EXISTS pg_ethiopian_from_date(text);
+DROP FUNCTION IF EXISTS pg_ethiopian_to_date(timestamp);
+DROP FUNCTION IF EXISTS ethiopian_calendar_implementation();
+DROP FUNCTION IF EXISTS ethiopian_calendar_version();
+DROP FUNCTION IF EXISTS current_ethiopian_date();
+DROP FUNCTION IF EXISTS to_ethiopian_datetime(timestamp);
+DROP FUNCTION IF EXISTS to_ethiopian_timestamp();
+DROP FUNCTION IF EXISTS to_ethiopian_timestamp(timestamp);
+DROP FUNCTION IF EXISTS from_ethiopian_date(text);
+DROP FUNCTION IF EXISTS to_ethiopian_date();
+DROP FUNCTION IF EXISTS to_ethiopian_date(timestamp);
+DROP FUNCTION IF EXISTS _ethiopian_to_jdn(integer, integer, integer);
+DROP FUNCTION IF EXISTS _jdn_to_ethiopian(integer);
+DROP FUNCTION IF EXISTS _jdn_to_gregorian(integer);
+DROP FUNCTION IF EXISTS _gregorian_to_jdn(integer, integer, integer);
+DROP FUNCTION IF EXISTS _ethiopian_from_date_slow(text);
+DROP FUNCTION IF EXISTS _ethiopian_epoch_error(timestamp, anyelement);
+DROP FUNCTION IF EXISTS _ethiopian_parts_to_timestamp(integer, integer, integer);
+DROP FUNCTION IF EXISTS _ethiopian_date_valid(integer, integer, integer);
+DROP FUNCTION IF EXISTS _ethiopian_format(integer);
+DROP FUNCTION IF EXISTS _ethiopian_day(integer);
+DROP FUNCTION IF EXISTS _ethiopian_month(integer);
+DROP FUNCTION IF EXISTS _ethiopian_day_of_year(integer);
+DROP FUNCTION IF EXISTS _ethiopian_year(integer);
+DROP FUNCTION IF EXISTS _ethiopian_epoch_days(timestamp);
+`.trim();
+
+const EXTENSION = "pg_ethiopian_calendar";
+
+/** Converts one row per day from 1900-01-01; count() keeps the result off the wire */
+const BENCHMARK_SQL = `
+SELECT count(to_ethiopian_date(ts))
+FROM generate_series(timestamp '1900-01-01', timestamp '1900-01-01' + ($1::int - 1) * interval '1 day', interval '1 day') ts`;
+
+function message(err: unknown): string {
+  return err instanceof Error ? err.message : String(err);
+}
+
+/** Whether the server can create the C extension, and its installed version if any */
+export async function probeExtension(
+  client: Queryable
+): Promise<{ available: boolean; installedVersion: string | null }> {
+  const { rows } = await client.query(
+    "SELECT installed_version FROM pg_available_extensions WHERE name = $1",
+    [EXTENSION]
+  );
+  return { available: rows.length > 0, installedVersion: rows[0]?.installed_version ?? null };
+}
+
+/** Best of three runs after a warm-up, in nanoseconds per converted row */
+export async function benchmark(client: Queryable, rows = 100000): Promise<number> {
+  await client.query(BENCHMARK_SQL, [rows]);
+
+  let best = Infinity;
+  for (let i = 0; i < 3; i++) {
+    const started = process.hrtime.bigint();
+    await client.query(BENCHMARK_SQL, [rows]);
+    best = Math.min(best, Number(process.hrtime.bigint() - started));
+  }
+  return best / rows;
+}
+
+/** True if to_ethiopian_date() exists outside an extension, i.e. from a SQL variant */
+async function hasSqlVariant(client: Queryable): Promise<boolean> {
+  const { rows } = await client.query(`
+    SELECT EXISTS (
+      SELECT 1 FROM pg_proc p JOIN pg_namespace n ON n.oid = p.pronamespace
+      WHERE p.proname = 'to_ethiopian_date'
+        AND n.nspname = ANY (current_schemas(false))
+        AND NOT EXISTS (SELECT 1 FROM pg_depend d
+                        WHERE d.classid = 'pg_proc'::regclass AND d.objid = p.oid AND d.deptype = 'e')
+    ) AS present`);
+  return rows[0].present === true;
+}
+
+function sqlFor(implementation: Implementation): string {
+  return getSql(implementation === "sql-inline" ? "inline" : "plpgsql");
+}
+
+/** Installs the extension (replacing SQL-variant functions) and benchmarks it; rolls back on error */
+async function installExtension(client: Queryable, rows: number): Promise<number> {
+  await client.query("BEGIN");
+  try {
+    if (await hasSqlVariant(client)) await client.query(DROP_FUNCTIONS_SQL);
+    await client.query(`CREATE EXTENSION IF NOT EXISTS ${EXTENSION}`);
+    const nsPerRow = await benchmark(client, rows);
+    await client.query("COMMIT");
+    return nsPerRow;
+  } catch (err) {
+    await client.query("ROLLBACK");
+    throw err;
+  }
+}
+
+/** Installs a SQL variant in a transaction, benchmarks it and always rolls back */
+async function trySqlVariant(client: Queryable, implementation: Implementation, rows: number): Promise<number> {
+  await client.query("BEGIN");
+  try {
+    await client.query(sqlFor(implementation));
+    return await benchmark(client, rows);
+  } finally {
+    await client.query("ROLLBACK");
+  }
+}
+
+async function recordChoice(client: Queryable, chosen: Candidate, candidates: Candidate[]): Promise<void> {
+  const others = candidates
+    .filter((c) => c !== chosen && c.nsPerRow !== undefined)
+    .map((c) => `${c.implementation} ${Math.round(c.nsPerRow!)} ns/row`);
+  const comment =
+    `Installed by ethiopian-calendar install on ${new Date().toISOString()}: ` +
+    `${chosen.implementation} ${Math.round(chosen.nsPerRow!)} ns/row` +
+    (others.length ? ` (also measured: ${others.join(", ")})` : "");
+
+  // The extension may have been created by another role; the comment is informational
+  try {
+    await client.query(`COMMENT ON FUNCTION ethiopian_calendar_implementation() IS '${comment.replace(/'/g, "''")}'`);
+  } catch {
+    /* not the owner */
+  }
+}
+
+/**
+ * Probes the database, installs the fastest available implementation and
+ * records the choice. Throws if no candidate could be installed.
+ */
+export async function install(client: Queryable, options: InstallOptions = {}): Promise<InstallResult> {
+  const rows = options.benchmarkRows ?? 100000;
+  const progress = options.onProgress ?? (() => {});
+  const candidates: Candidate[] = [];
+
+  if (!options.only || options.only === "c-extension") {
+    const probe = await probeExtension(client);
+    if (probe.available) {
+      progress(`${EXTENSION} is available${probe.installedVersion ? ` (installed: ${probe.installedVersion})` : ""}`);
+      const candidate: Candidate = { implementation: "c-extension" };
+      candidates.push(candidate);
+      try {
+        candidate.nsPerRow = await installExtension(client, rows);
+        await recordChoice(client, candidate, candidates);
+        return { implementation: "c-extension", nsPerRow: candidate.nsPerRow, candidates };
+      } catch (err) {
+        candidate.error = message(err);
+        progress(`Cannot create ${EXTENSION}: ${candidate.error}`);
+      }
+    } else {
+      progress(`${EXTENSION} is not available on this server`);
+    }
+  }
+
+  const sqlVariants: Implementation[] = options.only
+    ? options.only === "c-extension" ? [] : [options.only]
+    : ["sql-inline", "plpgsql"];
+
+  for (const implementation of sqlVariants) {
+    const candidate: Candidate = { implementation };
+    candidates.push(candidate);
+    try {
+      candidate.nsPerRow = await trySqlVariant(client, implementation, rows);
+      progress(`${implementation}: ${Math.round(candidate.nsPerRow)} ns/row`);
+    } catch (err) {
+      candidate.error = message(err);
+      progress(`${implementation}: ${candidate.error}`);
+    }
+  }
+
+  const measured = candidates.filter((c) => c.implementation !== "c-extension" && c.nsPerRow !== undefined);
+  if (measured.length === 0) {
+    const errors = candidates.map((c) => `${c.implementation}: ${c.error}`).join("; ");
+    throw new Error(`No implementation could be installed (${errors})`);
+  }
+  const best = measured.reduce((a, b) => (b.nsPerRow! < a.nsPerRow! ? b : a));
+
+  await client.query("BEGIN");
+  try {
+    await client.query(sqlFor(best.implementation));
+    await client.query("COMMIT");
+  } catch (err) {
+    await client.query("ROLLBACK");
+    throw err;
+  }
+  await recordChoice(client, best, candidates);
+
+  return { implementation: best.implementation, nsPerRow: best.nsPerRow!, candidates };
+}
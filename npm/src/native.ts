@@ -0,0 +1,109 @@
+import { join, dirname } from "path";
+
+/**
+ * Optional native addon built from the extension's C kernels (native/).
+ *
+ * Converts dates in-process with the same results as the SQL functions. It is
+ * compiled on install when a C toolchain is available; otherwise every
+ * function here throws and the SQL functions (getSql()) remain the way to
+ * convert dates.
+ */
+
+interface NativeBindings {
+  toEthiopianDate(unixDay: number): string;
+  fromEthiopianDate(text: string): number;
+  toEthiopianParts(unixDays: Int32Array, years: Int32Array, months: Int32Array, days: Int32Array): number;
+  fromEthiopianParts(years: Int32Array, months: Int32Array, days: Int32Array, unixDays: Int32Array): number;
+}
+
+const ADDON_PATH = join(dirname(__dirname), "native", "build", "Release", "ethiopian_calendar.node");
+const MS_PER_DAY = 86400000;
+
+let bindings: NativeBindings | null | undefined;
+
+function load(): NativeBindings | null {
+  if (bindings === undefined) {
+    try {
+      bindings = require(ADDON_PATH) as NativeBindings;
+    } catch {
+      bindings = null;
+    }
+  }
+  return bindings;
+}
+
+function native(): NativeBindings {
+  const addon = load();
+  if (!addon) {
+    throw new Error(
+      "Native addon is not built (run `npm run build:native` in @huluwz/pg-ethiopian-calendar); use the SQL functions instead"
+    );
+  }
+  return addon;
+}
+
+/** Converts a Date (its UTC calendar day) or Unix day number to a day number */
+function toUnixDay(value: Date | number): number {
+  return value instanceof Date ? Math.floor(value.getTime() / MS_PER_DAY) : value;
+}
+
+/** Returns true if the native addon is built and loadable */
+export function isNativeAvailable(): boolean {
+  return load() !== null;
+}
+
+/**
+ * Converts a Gregorian date to an Ethiopian date string (YYYY-MM-DD).
+ * Same as SQL `to_ethiopian_date()`; a Date is taken by its UTC calendar day.
+ */
+export function toEthiopianDate(value: Date | number): string {
+  return native().toEthiopianDate(toUnixDay(value));
+}
+
+/** Converts an Ethiopian date string (YYYY-MM-DD) to a Gregorian Date at UTC midnight. Same as SQL `from_ethiopian_date()` */
+export function fromEthiopianDate(text: string): Date {
+  return new Date(native().fromEthiopianDate(text) * MS_PER_DAY);
+}
+
+/** Converts an Ethiopian date string (YYYY-MM-DD) to a Unix day number (days since 1970-01-01) */
+export function fromEthiopianDateToDay(text: string): number {
+  return native().fromEthiopianDate(text);
+}
+
+export interface EthiopianParts {
+  years: Int32Array;
+  months: Int32Array;
+  days: Int32Array;
+  /** Number of inputs outside the range toEthiopianDate() accepts (their parts are 0) */
+  invalid: number;
+}
+
+/**
+ * Batch-converts Unix day numbers to Ethiopian year/month/day arrays.
+ * Pass `out` to reuse buffers across calls.
+ */
+export function toEthiopianParts(
+  unixDays: Int32Array,
+  out?: Omit<EthiopianParts, "invalid">
+): EthiopianParts {
+  const n = unixDays.length;
+  const years = out?.years ?? new Int32Array(n);
+  const months = out?.months ?? new Int32Array(n);
+  const days = out?.days ?? new Int32Array(n);
+  const invalid = native().toEthiopianParts(unixDays, years, months, days);
+  return { years, months, days, invalid };
+}
+
+/**
+ * Batch-converts Ethiopian year/month/day arrays to Unix day numbers.
+ * Invalid dates get -2147483648; returns the day numbers and the invalid count.
+ */
+export function fromEthiopianParts(
+  years: Int32Array,
+  months: Int32Array,
+  days: Int32Array,
+  out: Int32Array = new Int32Array(years.length)
+): { unixDays: Int32Array; invalid: number } {
+  const invalid = native().fromEthiopianParts(years, months, days, out);
+  return { unixDays: out, invalid };
+}
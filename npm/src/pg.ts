@@ -0,0 +1,194 @@
+/**
+ * node-postgres type parsers for Ethiopian calendar results.
+ *
+ * The extension returns Ethiopian dates as TEXT ("YYYY-MM-DD") and Ethiopian
+ * timestamps as TIMESTAMP values whose fields hold Ethiopian components
+ * (to_ethiopian_timestamp()). Neither is a valid JS Date, so these parsers
+ * decode them into plain objects. With `binary: true`, a timestamp is
+ * decoded straight from its 8 bytes without building a string.
+ *
+ * The extension defines no base types of its own (ethiopian_date_text is a
+ * domain and goes over the wire as text), so the parsers are keyed by the
+ * built-in TEXT and TIMESTAMP OIDs and meant to be used per query:
+ *
+ *   client.query({ text, values, binary: true, types: ethiopianTypes() })
+ */
+
+/** Built-in type OIDs used on the wire */
+export const TEXT_OID = 25;
+export const TIMESTAMP_OID = 1114;
+
+/** Julian Day Number of 2000-01-01, PostgreSQL's timestamp epoch */
+const POSTGRES_EPOCH_JDN = 2451545;
+const USECS_PER_DAY = 86400000000;
+const TWO_POW_32 = 4294967296;
+
+export interface EthiopianDate {
+  year: number;
+  month: number;
+  day: number;
+}
+
+export interface EthiopianDateTime extends EthiopianDate {
+  hour: number;
+  minute: number;
+  second: number;
+  microsecond: number;
+}
+
+type TypeFormat = "text" | "binary";
+type TypeParser = (value: any) => unknown;
+
+/** Structural subset of pg's `types` option / pg-types */
+export interface TypeParserSource {
+  getTypeParser(oid: number, format?: TypeFormat): TypeParser;
+}
+
+/** Same arithmetic as jdn_to_gregorian() in the C extension */
+function jdnToFields(jdn: number): EthiopianDate {
+  const a = jdn + 32044;
+  const b = Math.floor((4 * a + 3) / 146097);
+  const c = a - Math.floor((b * 146097) / 4);
+  const d = Math.floor((4 * c + 3) / 1461);
+  const e = c - Math.floor((1461 * d) / 4);
+  const m = Math.floor((5 * e + 2) / 153);
+
+  return {
+    year: b * 100 + d - 4800 + Math.floor(m / 10),
+    month: m + 3 - 12 * Math.floor(m / 10),
+    day: e - Math.floor((153 * m + 2) / 5) + 1,
+  };
+}
+
+function fieldsFromDays(days: number, usecOfDay: number): EthiopianDateTime {
+  const date = jdnToFields(days + POSTGRES_EPOCH_JDN) as EthiopianDateTime;
+  const secs = Math.floor(usecOfDay / 1000000);
+
+  date.hour = Math.floor(secs / 3600);
+  date.minute = Math.floor(secs / 60) % 60;
+  date.second = secs % 60;
+  date.microsecond = usecOfDay % 1000000;
+  return date;
+}
+
+/**
+ * Decodes a binary TIMESTAMP (int64 microseconds since 2000-01-01) holding
+ * Ethiopian components. Returns ±Infinity for infinite timestamps.
+ */
+export function parseEthiopianTimestampBinary(buf: Buffer): EthiopianDateTime | number {
+  const hi = buf.readInt32BE(0);
+  const lo = buf.readUInt32BE(4);
+
+  if (hi === 0x7fffffff && lo === 0xffffffff) return Infinity;
+  if (hi === -0x80000000 && lo === 0) return -Infinity;
+
+  // Within ±2^52 µs (about ±142 years around 2000) a double is exact
+  if (hi >= -0x100000 && hi < 0x100000) {
+    const usecs = hi * TWO_POW_32 + lo;
+    const days = Math.floor(usecs / USECS_PER_DAY);
+    return fieldsFromDays(days, usecs - days * USECS_PER_DAY);
+  }
+
+  const usecs = buf.readBigInt64BE(0);
+  const perDay = BigInt(USECS_PER_DAY);
+  let days = usecs / perDay;
+  let rem = usecs % perDay;
+  if (rem < 0n) {
+    days -= 1n;
+    rem += perDay;
+  }
+  return fieldsFromDays(Number(days), Number(rem));
+}
+
+/**
+ * Matches "\d+-\d\d-\d\d" at the start of the value and returns its fields
+ * and length, or null when the value does not start with that shape.
+ */
+function matchDate(code: (i: number) => number, len: number): { date: EthiopianDate; end: number } | null {
+  const digit = (i: number) => i < len && code(i) >= 48 && code(i) <= 57;
+
+  // Year may have more than four digits; month and day follow the first '-'
+  let i = 0;
+  let year = 0;
+  for (; digit(i); i++) year = year * 10 + code(i) - 48;
+  if (i === 0 || code(i) !== 45 || !digit(i + 1) || !digit(i + 2)) return null;
+  if (code(i + 3) !== 45 || !digit(i + 4) || !digit(i + 5)) return null;
+
+  const month = (code(i + 1) - 48) * 10 + code(i + 2) - 48;
+  const day = (code(i + 4) - 48) * 10 + code(i + 5) - 48;
+  return { date: { year, month, day }, end: i + 6 };
+}
+
+/**
+ * Parses a text TIMESTAMP ("YYYY-MM-DD HH:MI:SS[.ffffff][ BC]") holding
+ * Ethiopian components. BC years are returned astronomically (1 BC is year
+ * 0), as the binary parser does. Text that is not a timestamp is returned
+ * unchanged.
+ */
+export function parseEthiopianTimestampText(value: string): EthiopianDateTime | number | string {
+  if (value === "infinity") return Infinity;
+  if (value === "-infinity") return -Infinity;
+
+  const match = matchDate((i) => value.charCodeAt(i), value.length);
+  if (match === null || value.charCodeAt(match.end) !== 32) return value;
+
+  const date = match.date as EthiopianDateTime;
+  const time = match.end;
+  const bc = value.endsWith(" BC");
+  const end = bc ? value.length - 3 : value.length;
+  const frac = value.indexOf(".", time);
+
+  if (bc) date.year = 1 - date.year;
+  date.hour = Number(value.slice(time + 1, time + 3));
+  date.minute = Number(value.slice(time + 4, time + 6));
+  date.second = Number(value.slice(time + 7, time + 9));
+  date.microsecond = frac < 0 ? 0 : Number(value.slice(frac + 1, Math.min(frac + 7, end)).padEnd(6, "0"));
+  return date;
+}
+
+/**
+ * Parses an Ethiopian date ("YYYY-MM-DD", as returned by to_ethiopian_date()).
+ * Accepts a string or, in binary mode, the raw UTF-8 bytes. Any other value
+ * (a TEXT column that is not an Ethiopian date) is returned unchanged.
+ */
+export function parseEthiopianDate(value: string): EthiopianDate | string;
+export function parseEthiopianDate(value: Buffer): EthiopianDate | Buffer;
+export function parseEthiopianDate(value: string | Buffer): EthiopianDate | string | Buffer;
+export function parseEthiopianDate(value: string | Buffer): EthiopianDate | string | Buffer {
+  const text = typeof value === "string";
+  const code = (i: number) => (text ? (value as string).charCodeAt(i) : (value as Buffer)[i]);
+  const match = matchDate(code, value.length);
+
+  return match !== null && match.end === value.length ? match.date : value;
+}
+
+/**
+ * Returns a `types` object for node-postgres queries whose TEXT and/or
+ * TIMESTAMP columns are Ethiopian calendar values. Other types, and TEXT
+ * values that are not "YYYY-MM-DD", fall back to `base` (pass `pg.types`);
+ * without it they are returned unparsed.
+ */
+export function ethiopianTypes(
+  options: { date?: boolean; timestamp?: boolean } = {},
+  base?: TypeParserSource
+): TypeParserSource {
+  const { date = true, timestamp = true } = options;
+
+  return {
+    getTypeParser(oid: number, format: TypeFormat = "text"): TypeParser {
+      if (timestamp && oid === TIMESTAMP_OID) {
+        return format === "binary" ? parseEthiopianTimestampBinary : parseEthiopianTimestampText;
+      }
+      if (date && oid === TEXT_OID) {
+        if (!base) return parseEthiopianDate;
+        const fallback = base.getTypeParser(oid, format);
+        return (value: string | Buffer) => {
+          const parsed = parseEthiopianDate(value);
+          return parsed === value ? fallback(value) : parsed;
+        };
+      }
+      if (base) return base.getTypeParser(oid, format);
+      return (value: unknown) => value;
+    },
+  };
+}
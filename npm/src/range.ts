@@ -0,0 +1,138 @@
+/**
+ * Index-friendly Ethiopian date filters.
+ *
+ * `WHERE to_ethiopian_date(created_at) = '2016-04-23'` has to convert every
+ * row and cannot use a plain index on created_at. These helpers compute the
+ * Gregorian boundaries of an Ethiopian day, month, year or date span up front
+ * (same arithmetic as the C extension), so the filter becomes a half-open
+ * range on the raw column that PostgreSQL can answer with an index range scan:
+ *
+ *   created_at >= '2023-12-11' AND created_at < '2024-01-10'
+ */
+
+const ETHIOPIAN_EPOCH = 1724221;
+
+/** Half-open Gregorian range [gte, lt); can be passed directly as a Prisma filter */
+export interface EthiopianRange {
+  gte: Date;
+  lt: Date;
+}
+
+/** Parameterized SQL predicate ($n placeholders) with its values */
+export interface RangePredicate {
+  sql: string;
+  values: [string, string];
+}
+
+/** Same arithmetic as ethiopian_to_jdn() in the C extension */
+function ethiopianToJdn(year: number, month: number, day: number): number {
+  const era = Math.trunc((year - 1) / 4);
+  const yearOfEra = (year - 1) % 4;
+  return ETHIOPIAN_EPOCH + era * 1461 + yearOfEra * 365 + (month - 1) * 30 + (day - 1);
+}
+
+/** Same arithmetic as jdn_to_gregorian() in the C extension, as a UTC-midnight Date */
+function jdnToDate(jdn: number): Date {
+  const a = jdn + 32044;
+  const b = Math.floor((4 * a + 3) / 146097);
+  const c = a - Math.floor((b * 146097) / 4);
+  const d = Math.floor((4 * c + 3) / 1461);
+  const e = c - Math.floor((1461 * d) / 4);
+  const m = Math.floor((5 * e + 2) / 153);
+
+  const date = new Date(0);
+  date.setUTCFullYear(
+    b * 100 + d - 4800 + Math.floor(m / 10),
+    m + 3 - 12 * Math.floor(m / 10) - 1,
+    e - Math.floor((153 * m + 2) / 5) + 1
+  );
+  return date;
+}
+
+function checkYear(year: number): void {
+  if (!Number.isInteger(year) || year < 1) {
+    throw new RangeError(`invalid Ethiopian year: ${year} (must be >= 1)`);
+  }
+}
+
+function checkMonth(month: number): void {
+  if (!Number.isInteger(month) || month < 1 || month > 13) {
+    throw new RangeError(`invalid Ethiopian month: ${month} (must be 1-13)`);
+  }
+}
+
+/** Parses "YYYY-MM-DD" with the same validation as from_ethiopian_date() */
+function parseDate(text: string): [number, number, number] {
+  const match = /^\s*(\d+)-(\d+)-(\d+)\s*$/.exec(text);
+  if (!match) {
+    throw new RangeError(`invalid Ethiopian date format: ${text} (expected YYYY-MM-DD)`);
+  }
+  const [year, month, day] = [Number(match[1]), Number(match[2]), Number(match[3])];
+  checkYear(year);
+  checkMonth(month);
+  const maxDays = month <= 12 ? 30 : year % 4 === 3 ? 6 : 5;
+  if (day < 1 || day > maxDays) {
+    throw new RangeError(`invalid Ethiopian day: ${day} (month ${month} has ${maxDays} days in year ${year})`);
+  }
+  return [year, month, day];
+}
+
+function range(startJdn: number, endJdn: number): EthiopianRange {
+  return { gte: jdnToDate(startJdn), lt: jdnToDate(endJdn) };
+}
+
+/** Gregorian range of one Ethiopian day ("YYYY-MM-DD") */
+export function ethiopianDayRange(date: string): EthiopianRange {
+  const start = ethiopianToJdn(...parseDate(date));
+  return range(start, start + 1);
+}
+
+/** Gregorian range of an Ethiopian month (13 = Pagumē) */
+export function ethiopianMonthRange(year: number, month: number): EthiopianRange {
+  checkYear(year);
+  checkMonth(month);
+  const next = month === 13 ? ethiopianToJdn(year + 1, 1, 1) : ethiopianToJdn(year, month + 1, 1);
+  return range(ethiopianToJdn(year, month, 1), next);
+}
+
+/** Gregorian range of an Ethiopian year (Meskerem 1 to Pagumē 5/6) */
+export function ethiopianYearRange(year: number): EthiopianRange {
+  checkYear(year);
+  return range(ethiopianToJdn(year, 1, 1), ethiopianToJdn(year + 1, 1, 1));
+}
+
+/** Gregorian range covering Ethiopian dates from..to, both days inclusive */
+export function ethiopianRangeBetween(from: string, to: string): EthiopianRange {
+  return range(ethiopianToJdn(...parseDate(from)), ethiopianToJdn(...parseDate(to)) + 1);
+}
+
+/** Formats a range boundary as a timestamp literal ("YYYY-MM-DD") */
+function formatDate(date: Date): string {
+  return date.toISOString().slice(0, 10);
+}
+
+/**
+ * Builds `column >= $n::timestamp AND column < $n+1::timestamp` for a range.
+ * Values are date strings, so the result does not depend on the client's time zone.
+ */
+export function rangePredicate(column: string, r: EthiopianRange, firstParam = 1): RangePredicate {
+  return {
+    sql: `${column} >= $${firstParam}::timestamp AND ${column} < $${firstParam + 1}::timestamp`,
+    values: [formatDate(r.gte), formatDate(r.lt)],
+  };
+}
+
+/** Sargable predicate for rows whose column falls in an Ethiopian month */
+export function inEthiopianMonth(column: string, year: number, month: number, firstParam = 1): RangePredicate {
+  return rangePredicate(column, ethiopianMonthRange(year, month), firstParam);
+}
+
+/** Sargable predicate for rows whose column falls in an Ethiopian year */
+export function inEthiopianYear(column: string, year: number, firstParam = 1): RangePredicate {
+  return rangePredicate(column, ethiopianYearRange(year), firstParam);
+}
+
+/** Sargable predicate for rows whose column falls between two Ethiopian dates (inclusive) */
+export function betweenEthiopian(column: string, from: string, to: string, firstParam = 1): RangePredicate {
+  return rangePredicate(column, ethiopianRangeBetween(from, to), firstParam);
+}
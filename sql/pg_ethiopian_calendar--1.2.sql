@@ -0,0 +1,948 @@
+-- pg_ethiopian_calendar--1.2.sql
+-- 
+-- PostgreSQL extension for converting Gregorian timestamps to Ethiopian calendar dates.
+-- 
+-- Implementation based on formulas from:
+--   Nachum Dershowitz & Edward M. Reingold,
+--   "Calendrical Calculations", Cambridge University Press.
+-- 
+-- The Ethiopian calendar has:
+--   - 13 months: 12 months of 30 days each, plus a 13th month of 5 or 6 days
+--   - Year starts around September 11-12 in the Gregorian calendar
+--   - Uses a different epoch than the Gregorian calendar
+
+-- Function: to_ethiopian_date(timestamp)
+-- 
+-- Converts a Gregorian timestamp to an Ethiopian calendar date as text.
+-- Returns the Ethiopian date in format: "YYYY-MM-DD"
+-- The time component is discarded; only the date is converted.
+-- 
+-- Parameters:
+--   timestamp: Gregorian calendar timestamp
+-- 
+-- Returns: TEXT (Ethiopian calendar date as string in format YYYY-MM-DD)
+CREATE FUNCTION to_ethiopian_date(timestamp)
+RETURNS text
+AS 'MODULE_PATHNAME', 'to_ethiopian_date'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION to_ethiopian_date(timestamp) IS
+'Converts a Gregorian timestamp to an Ethiopian calendar date as text (format: YYYY-MM-DD). The time component is discarded.';
+
+-- Function: to_ethiopian_datetime(timestamp)
+-- 
+-- Converts a Gregorian timestamp to an Ethiopian calendar TIMESTAMP WITH TIME ZONE.
+-- The date is converted to Ethiopian calendar; the time-of-day remains the same.
+-- 
+-- Parameters:
+--   timestamp: Gregorian calendar timestamp
+-- 
+-- Returns: TIMESTAMP WITH TIME ZONE (date in Ethiopian calendar, time unchanged)
+CREATE FUNCTION to_ethiopian_datetime(timestamp)
+RETURNS timestamp with time zone
+AS 'MODULE_PATHNAME', 'to_ethiopian_datetime'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION to_ethiopian_datetime(timestamp) IS
+'Converts a Gregorian timestamp to an Ethiopian calendar TIMESTAMP WITH TIME ZONE. The date is converted to Ethiopian calendar; the time-of-day remains the same.';
+
+-- Function: from_ethiopian_date(text)
+-- 
+-- Converts an Ethiopian calendar date string to a Gregorian timestamp.
+-- The input should be in format "YYYY-MM-DD" (Ethiopian calendar).
+-- 
+-- Parameters:
+--   ethiopian_date: Ethiopian calendar date as text (format: YYYY-MM-DD)
+-- 
+-- Returns: TIMESTAMP (Gregorian calendar timestamp at midnight)
+CREATE FUNCTION from_ethiopian_date(text)
+RETURNS timestamp
+AS 'MODULE_PATHNAME', 'from_ethiopian_date'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION from_ethiopian_date(text) IS
+'Converts an Ethiopian calendar date string to a Gregorian timestamp. Input format: YYYY-MM-DD (Ethiopian calendar). Returns timestamp at midnight.';
+
+-- pg_ prefixed function aliases (PostgreSQL extension naming convention)
+-- These provide the standard pg_ prefix while maintaining backward compatibility
+
+-- Alias: pg_ethiopian_to_date (same as to_ethiopian_date)
+CREATE FUNCTION pg_ethiopian_to_date(timestamp)
+RETURNS text
+AS 'MODULE_PATHNAME', 'to_ethiopian_date'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION pg_ethiopian_to_date(timestamp) IS
+'Alias for to_ethiopian_date(). Converts a Gregorian timestamp to an Ethiopian calendar date as text (format: YYYY-MM-DD).';
+
+-- Alias: pg_ethiopian_from_date (same as from_ethiopian_date)
+CREATE FUNCTION pg_ethiopian_from_date(text)
+RETURNS timestamp
+AS 'MODULE_PATHNAME', 'from_ethiopian_date'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION pg_ethiopian_from_date(text) IS
+'Alias for from_ethiopian_date(). Converts an Ethiopian calendar date string to a Gregorian timestamp. Input format: YYYY-MM-DD.';
+
+-- Alias: pg_ethiopian_to_datetime (same as to_ethiopian_datetime)
+CREATE FUNCTION pg_ethiopian_to_datetime(timestamp)
+RETURNS timestamp with time zone
+AS 'MODULE_PATHNAME', 'to_ethiopian_datetime'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION pg_ethiopian_to_datetime(timestamp) IS
+'Alias for to_ethiopian_datetime(). Converts a Gregorian timestamp to an Ethiopian calendar TIMESTAMP WITH TIME ZONE. The date is converted to Ethiopian calendar; the time-of-day remains the same.';
+
+-- Function: current_ethiopian_date()
+-- 
+-- Returns the current date in Ethiopian calendar as text.
+-- This function is STABLE (not IMMUTABLE) because it depends on the current time.
+-- Useful for DEFAULT values and queries that need the current Ethiopian date.
+-- 
+-- Returns: TEXT (current Ethiopian calendar date as string in format YYYY-MM-DD)
+CREATE FUNCTION current_ethiopian_date()
+RETURNS text
+AS 'MODULE_PATHNAME', 'current_ethiopian_date'
+LANGUAGE C STABLE;
+
+COMMENT ON FUNCTION current_ethiopian_date() IS
+'Returns the current date in Ethiopian calendar as text (format: YYYY-MM-DD). This function is STABLE because it depends on the current time. Useful for DEFAULT values and generated columns.';
+
+-- Function: to_ethiopian_timestamp(timestamp)
+-- 
+-- Converts a Gregorian timestamp to an Ethiopian calendar TIMESTAMP.
+-- The date is converted to Ethiopian calendar; the time-of-day remains the same.
+-- This function returns TIMESTAMP (without time zone) for use in generated columns.
+-- 
+-- Parameters:
+--   timestamp: Gregorian calendar timestamp
+-- 
+-- Returns: TIMESTAMP (Ethiopian calendar date with original time preserved)
+CREATE FUNCTION to_ethiopian_timestamp(timestamp)
+RETURNS timestamp
+AS 'MODULE_PATHNAME', 'to_ethiopian_timestamp'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION to_ethiopian_timestamp(timestamp) IS
+'Converts a Gregorian timestamp to an Ethiopian calendar TIMESTAMP. The date is converted to Ethiopian calendar; the time-of-day remains the same. Returns TIMESTAMP (without time zone) for use in generated columns.';
+
+-- Alias: pg_ethiopian_to_timestamp (same as to_ethiopian_timestamp)
+CREATE FUNCTION pg_ethiopian_to_timestamp(timestamp)
+RETURNS timestamp
+AS 'MODULE_PATHNAME', 'to_ethiopian_timestamp'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION pg_ethiopian_to_timestamp(timestamp) IS
+'Alias for to_ethiopian_timestamp(). Converts a Gregorian timestamp to an Ethiopian calendar TIMESTAMP. The date is converted to Ethiopian calendar; the time-of-day remains the same.';
+
+-- Domain: ethiopian_date_text
+-- 
+-- TEXT domain for Ethiopian dates in the fixed "YYYY-MM-DD" format, using the
+-- "C" collation. Zero-padded ISO-style strings sort correctly byte by byte, so
+-- comparisons never go through ICU/glibc and sorts and index builds are cheaper.
+CREATE DOMAIN ethiopian_date_text AS text COLLATE "C";
+
+COMMENT ON DOMAIN ethiopian_date_text IS
+'Ethiopian calendar date as text (format: YYYY-MM-DD) with the "C" collation for byte-wise sorting and indexing.';
+
+-- Function: to_ethiopian_date_text(timestamp)
+-- 
+-- Same conversion as to_ethiopian_date(), but returns ethiopian_date_text so
+-- the result (and any generated column or index built on it) uses the "C" collation.
+-- 
+-- Parameters:
+--   timestamp: Gregorian calendar timestamp
+-- 
+-- Returns: ETHIOPIAN_DATE_TEXT (Ethiopian calendar date as string in format YYYY-MM-DD)
+CREATE FUNCTION to_ethiopian_date_text(timestamp)
+RETURNS ethiopian_date_text
+AS 'MODULE_PATHNAME', 'to_ethiopian_date'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION to_ethiopian_date_text(timestamp) IS
+'Converts a Gregorian timestamp to an Ethiopian calendar date as ethiopian_date_text (format: YYYY-MM-DD, "C" collation). The time component is discarded.';
+
+-- Alias: pg_ethiopian_to_date_text (same as to_ethiopian_date_text)
+CREATE FUNCTION pg_ethiopian_to_date_text(timestamp)
+RETURNS ethiopian_date_text
+AS 'MODULE_PATHNAME', 'to_ethiopian_date'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION pg_ethiopian_to_date_text(timestamp) IS
+'Alias for to_ethiopian_date_text(). Converts a Gregorian timestamp to an Ethiopian calendar date as ethiopian_date_text (format: YYYY-MM-DD).';
+
+-- Function: current_ethiopian_date_text()
+-- 
+-- Same as current_ethiopian_date(), but returns ethiopian_date_text.
+-- 
+-- Returns: ETHIOPIAN_DATE_TEXT (current Ethiopian calendar date as string in format YYYY-MM-DD)
+CREATE FUNCTION current_ethiopian_date_text()
+RETURNS ethiopian_date_text
+AS 'MODULE_PATHNAME', 'current_ethiopian_date'
+LANGUAGE C STABLE;
+
+COMMENT ON FUNCTION current_ethiopian_date_text() IS
+'Returns the current date in Ethiopian calendar as ethiopian_date_text (format: YYYY-MM-DD, "C" collation). This function is STABLE because it depends on the current time.';
+
+-- Function: ethiopian_buckets_support(internal)
+-- 
+-- Planner support function for ethiopian_buckets(): estimates the number of
+-- buckets when the range and granularity are known at plan time.
+CREATE FUNCTION ethiopian_buckets_support(internal)
+RETURNS internal
+AS 'MODULE_PATHNAME', 'ethiopian_buckets_support'
+LANGUAGE C IMMUTABLE STRICT;
+
+-- Function: ethiopian_buckets(timestamp, timestamp, text)
+-- 
+-- Generates one row per Ethiopian calendar bucket overlapping the Gregorian
+-- range [range_start, range_end), including buckets with no data, for
+-- gap-filling time series. Rows are returned in bucket_start order.
+-- 
+-- Parameters:
+--   range_start: Gregorian timestamp (inclusive)
+--   range_end:   Gregorian timestamp (exclusive)
+--   granularity: day, week, month, quarter, year or fiscal_year
+-- 
+-- Returns: SETOF (bucket_start TIMESTAMP, bucket_end TIMESTAMP, label TEXT)
+--   bucket_start/bucket_end are Gregorian midnights (bucket_end exclusive);
+--   label is the Ethiopian bucket name, e.g. 2016-04-23, 2016-W17, 2016-04,
+--   2016-Q2, 2016 or FY2016 (fiscal years run Hamle 1 to Sene 30)
+CREATE FUNCTION ethiopian_buckets(
+    range_start timestamp,
+    range_end timestamp,
+    granularity text,
+    OUT bucket_start timestamp,
+    OUT bucket_end timestamp,
+    OUT label text)
+RETURNS SETOF record
+AS 'MODULE_PATHNAME', 'ethiopian_buckets'
+LANGUAGE C IMMUTABLE STRICT
+ROWS 100
+SUPPORT ethiopian_buckets_support;
+
+COMMENT ON FUNCTION ethiopian_buckets(timestamp, timestamp, text) IS
+'Generates Ethiopian calendar buckets (day, week, month, quarter, year, fiscal_year) overlapping the Gregorian range [range_start, range_end), with Gregorian bucket_start/bucket_end timestamps and Ethiopian labels, ordered by bucket_start.';
+
+-- Function: ethiopian_year(timestamp)
+-- 
+-- Returns the Ethiopian year.
+-- 
+-- Returns: INTEGER
+CREATE FUNCTION ethiopian_year(timestamp)
+RETURNS integer
+AS 'MODULE_PATHNAME', 'ethiopian_year'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION ethiopian_year(timestamp) IS
+'Extracts the Ethiopian year from a Gregorian timestamp.';
+
+-- Function: ethiopian_month(timestamp)
+-- 
+-- Returns the Ethiopian month (1-13).
+-- 
+-- Returns: INTEGER
+CREATE FUNCTION ethiopian_month(timestamp)
+RETURNS integer
+AS 'MODULE_PATHNAME', 'ethiopian_month'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION ethiopian_month(timestamp) IS
+'Extracts the Ethiopian month (1-13) from a Gregorian timestamp.';
+
+-- Function: ethiopian_day(timestamp)
+-- 
+-- Returns the Ethiopian day of the month (1-30, or 1-6 in Pagumē).
+-- 
+-- Returns: INTEGER
+CREATE FUNCTION ethiopian_day(timestamp)
+RETURNS integer
+AS 'MODULE_PATHNAME', 'ethiopian_day'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION ethiopian_day(timestamp) IS
+'Extracts the Ethiopian day of the month (1-30, or 1-6 in Pagumē) from a Gregorian timestamp.';
+
+-- Function: ethiopian_day_of_year(timestamp)
+-- 
+-- Returns the day of the Ethiopian year (1-366).
+-- 
+-- Returns: INTEGER
+CREATE FUNCTION ethiopian_day_of_year(timestamp)
+RETURNS integer
+AS 'MODULE_PATHNAME', 'ethiopian_day_of_year'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION ethiopian_day_of_year(timestamp) IS
+'Extracts the day of the Ethiopian year (1-366) from a Gregorian timestamp.';
+
+-- Function: ethiopian_day_of_week(timestamp)
+-- 
+-- Returns the day of the week (0 = Sunday/Ehud ... 6 = Saturday, as in date_part).
+-- 
+-- Returns: INTEGER
+CREATE FUNCTION ethiopian_day_of_week(timestamp)
+RETURNS integer
+AS 'MODULE_PATHNAME', 'ethiopian_day_of_week'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION ethiopian_day_of_week(timestamp) IS
+'Extracts the day of the week (0 = Sunday/Ehud ... 6 = Saturday) from a Gregorian timestamp.';
+
+-- Function: ethiopian_week(timestamp)
+-- 
+-- Returns the week of the Ethiopian year (7-day blocks from Meskerem 1, 1-53).
+-- 
+-- Returns: INTEGER
+CREATE FUNCTION ethiopian_week(timestamp)
+RETURNS integer
+AS 'MODULE_PATHNAME', 'ethiopian_week'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION ethiopian_week(timestamp) IS
+'Extracts the week of the Ethiopian year (7-day blocks counted from Meskerem 1, 1-53) from a Gregorian timestamp.';
+
+-- Function: ethiopian_quarter(timestamp)
+-- 
+-- Returns the Ethiopian quarter (1-4, Pagumē is in quarter 4).
+-- 
+-- Returns: INTEGER
+CREATE FUNCTION ethiopian_quarter(timestamp)
+RETURNS integer
+AS 'MODULE_PATHNAME', 'ethiopian_quarter'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION ethiopian_quarter(timestamp) IS
+'Extracts the Ethiopian quarter (1-4, Pagumē belongs to quarter 4) from a Gregorian timestamp.';
+
+-- Function: ethiopian_fiscal_year(timestamp)
+-- 
+-- Returns the Ethiopian fiscal year (Hamle 1 to Sene 30, named after the year it ends in).
+-- 
+-- Returns: INTEGER
+CREATE FUNCTION ethiopian_fiscal_year(timestamp)
+RETURNS integer
+AS 'MODULE_PATHNAME', 'ethiopian_fiscal_year'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION ethiopian_fiscal_year(timestamp) IS
+'Extracts the Ethiopian fiscal year (Hamle 1 to Sene 30, named after the year in which it ends) from a Gregorian timestamp.';
+
+-- Function: is_ethiopian_leap_year(timestamp)
+-- 
+-- Returns whether the date falls in an Ethiopian leap year (year % 4 == 3).
+-- 
+-- Returns: BOOLEAN
+CREATE FUNCTION is_ethiopian_leap_year(timestamp)
+RETURNS boolean
+AS 'MODULE_PATHNAME', 'is_ethiopian_leap_year'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION is_ethiopian_leap_year(timestamp) IS
+'Returns true if the Gregorian timestamp falls in an Ethiopian leap year (year % 4 == 3).';
+
+-- Function: ethiopian_date_part_support(internal)
+-- 
+-- Planner support function for ethiopian_date_part(): rewrites calls with a
+-- constant field into a direct call to the matching extractor above.
+CREATE FUNCTION ethiopian_date_part_support(internal)
+RETURNS internal
+AS 'MODULE_PATHNAME', 'ethiopian_date_part_support'
+LANGUAGE C IMMUTABLE STRICT;
+
+-- Function: ethiopian_date_part(text, timestamp)
+-- 
+-- Extracts an Ethiopian calendar field, analogous to date_part().
+-- 
+-- Parameters:
+--   field:     year, month, day, doy, dow, week, quarter, fiscal_year or leap
+--   timestamp: Gregorian calendar timestamp
+-- 
+-- Returns: DOUBLE PRECISION
+CREATE FUNCTION ethiopian_date_part(text, timestamp)
+RETURNS double precision
+AS 'MODULE_PATHNAME', 'ethiopian_date_part'
+LANGUAGE C IMMUTABLE STRICT
+SUPPORT ethiopian_date_part_support;
+
+COMMENT ON FUNCTION ethiopian_date_part(text, timestamp) IS
+'Extracts an Ethiopian calendar field (year, month, day, doy, dow, week, quarter, fiscal_year, leap) from a Gregorian timestamp, analogous to date_part(). Constant fields are resolved at plan time.';
+
+-- Function: ethiopian_calendar_query_stats()
+-- 
+-- Per-query call statistics for the extension's C functions. Only collected
+-- when ethiopian_calendar is listed in shared_preload_libraries.
+-- 
+-- Returns: SETOF (dbid, queryid, funcid, calls, errors, total_time, engine)
+--   queryid matches pg_stat_statements.queryid; total_time is in milliseconds
+--   and stays 0 unless ethiopian_calendar.track_timing is on; engine is the
+--   ethiopian_calendar.engine kernel the calls ran with (auto resolved)
+CREATE FUNCTION ethiopian_calendar_query_stats(
+    OUT dbid oid,
+    OUT queryid bigint,
+    OUT funcid oid,
+    OUT calls bigint,
+    OUT errors bigint,
+    OUT total_time double precision,
+    OUT engine text)
+RETURNS SETOF record
+AS 'MODULE_PATHNAME', 'ethiopian_calendar_query_stats'
+LANGUAGE C STRICT VOLATILE;
+
+COMMENT ON FUNCTION ethiopian_calendar_query_stats() IS
+'Returns per-query call, error and timing statistics for Ethiopian calendar functions (requires shared_preload_libraries).';
+
+-- Function: ethiopian_calendar_query_stats_reset()
+-- 
+-- Discards all collected statistics. Superuser only unless granted.
+CREATE FUNCTION ethiopian_calendar_query_stats_reset()
+RETURNS void
+AS 'MODULE_PATHNAME', 'ethiopian_calendar_query_stats_reset'
+LANGUAGE C STRICT VOLATILE;
+
+REVOKE ALL ON FUNCTION ethiopian_calendar_query_stats_reset() FROM PUBLIC;
+
+COMMENT ON FUNCTION ethiopian_calendar_query_stats_reset() IS
+'Discards all statistics collected by ethiopian_calendar_query_stats().';
+
+-- View: ethiopian_calendar_query_stats
+-- 
+-- ethiopian_calendar_query_stats() with the function shown by signature.
+-- Join with pg_stat_statements on (dbid, queryid) for the query text.
+CREATE VIEW ethiopian_calendar_query_stats AS
+SELECT s.dbid,
+       s.queryid,
+       s.funcid::regprocedure AS function,
+       s.calls,
+       s.errors,
+       s.total_time,
+       s.engine
+FROM ethiopian_calendar_query_stats() s;
+
+COMMENT ON VIEW ethiopian_calendar_query_stats IS
+'Per-query call statistics for Ethiopian calendar functions, keyed by the pg_stat_statements queryid.';
+
+-- Function: ethiopian_calendar_implementation
+-- 
+-- Names the implementation providing the functions. The npm package's SQL
+-- variants define the same function ('plpgsql', 'sql-inline'), so callers can
+-- tell which one a database uses.
+CREATE FUNCTION ethiopian_calendar_implementation()
+RETURNS text
+LANGUAGE sql IMMUTABLE
+AS $$ SELECT 'c-extension'::text $$;
+
+COMMENT ON FUNCTION ethiopian_calendar_implementation() IS
+'Returns c-extension: the functions are provided by the pg_ethiopian_calendar C extension.';
+
+-- Function: ethiopian_calendar_advise
+-- 
+-- Scans the catalogs for Ethiopian calendar usage that costs storage or
+-- prevents index use:
+--   stored_ethiopian_text: TEXT columns generated from or defaulting to
+--     to_ethiopian_date(); savings assume the column is dropped and values
+--     are converted on read
+--   expression_index: indexes on a conversion function; savings are the
+--     whole index if a plain index on the source column already exists,
+--     otherwise its size minus an estimated plain timestamp index
+--   non_sargable_filter: pg_stat_statements queries (if installed and
+--     loaded) comparing a conversion of a column instead of the column
+-- 
+-- Parameters:
+--   schemas: schemas to inspect (default: all non-system schemas)
+-- 
+-- Returns: SETOF (category, object_name, detail, suggestion,
+--   estimated_savings_bytes); savings are NULL when not estimated
+CREATE FUNCTION ethiopian_calendar_advise(
+    schemas name[] DEFAULT NULL,
+    OUT category text,
+    OUT object_name text,
+    OUT detail text,
+    OUT suggestion text,
+    OUT estimated_savings_bytes bigint)
+RETURNS SETOF record
+LANGUAGE plpgsql STABLE
+AS $$
+DECLARE
+    conversions name[] := ARRAY[
+        'to_ethiopian_date', 'pg_ethiopian_to_date',
+        'to_ethiopian_date_text', 'pg_ethiopian_to_date_text',
+        'to_ethiopian_timestamp', 'pg_ethiopian_to_timestamp',
+        'to_ethiopian_datetime', 'pg_ethiopian_to_datetime',
+        'ethiopian_year', 'ethiopian_month', 'ethiopian_day',
+        'ethiopian_date_part']::name[];
+    text_conversions name[] := ARRAY[
+        'to_ethiopian_date', 'pg_ethiopian_to_date',
+        'to_ethiopian_date_text', 'pg_ethiopian_to_date_text']::name[];
+    pgss_schema name;
+    time_column text;
+    r record;
+BEGIN
+    -- Stored TEXT columns computed by a conversion
+    FOR r IN
+        SELECT DISTINCT c.oid::regclass AS rel, a.attname, a.attgenerated,
+               pg_get_expr(ad.adbin, ad.adrelid) AS expr,
+               greatest(c.reltuples, 0)::bigint AS reltuples,
+               coalesce(s.avg_width, 11) AS width
+        FROM pg_attrdef ad
+        JOIN pg_attribute a ON a.attrelid = ad.adrelid AND a.attnum = ad.adnum
+        JOIN pg_class c ON c.oid = ad.adrelid
+        JOIN pg_namespace n ON n.oid = c.relnamespace
+        JOIN pg_type t ON t.oid = a.atttypid
+        JOIN pg_depend d ON d.classid = 'pg_attrdef'::regclass AND d.objid = ad.oid
+                        AND d.refclassid = 'pg_proc'::regclass
+        JOIN pg_proc p ON p.oid = d.refobjid
+        LEFT JOIN pg_stats s ON s.schemaname = n.nspname AND s.tablename = c.relname
+                            AND s.attname = a.attname
+        WHERE p.proname = ANY (text_conversions)
+          AND (CASE t.typtype WHEN 'd' THEN t.typbasetype ELSE t.oid END)
+              IN ('text'::regtype, 'varchar'::regtype)
+          AND NOT a.attisdropped
+          AND (schemas IS NULL OR n.nspname = ANY (schemas))
+          AND n.nspname NOT IN ('pg_catalog', 'information_schema')
+    LOOP
+        category := 'stored_ethiopian_text';
+        object_name := format('%s.%I', r.rel, r.attname);
+        detail := format('%s column %s AS (%s), ~%s rows of %s bytes',
+                         CASE WHEN r.attgenerated = 's' THEN 'generated' ELSE 'default' END,
+                         quote_ident(r.attname), r.expr, r.reltuples, r.width);
+        suggestion := 'Drop the column and call to_ethiopian_date() in the SELECT list; '
+                      'filter on the source column with from_ethiopian_date() bounds '
+                      '(npm: inEthiopianMonth, betweenEthiopian)';
+        estimated_savings_bytes := r.reltuples * r.width;
+        RETURN NEXT;
+    END LOOP;
+
+    -- Expression indexes on a conversion
+    FOR r IN
+        SELECT DISTINCT i.indexrelid::regclass AS idx, i.indrelid::regclass AS rel,
+               pg_get_indexdef(i.indexrelid) AS def,
+               pg_relation_size(i.indexrelid) AS size,
+               greatest(c.reltuples, 0)::bigint AS reltuples,
+               (SELECT string_agg(quote_ident(a.attname), ', ')
+                FROM pg_depend dc
+                JOIN pg_attribute a ON a.attrelid = dc.refobjid AND a.attnum = dc.refobjsubid
+                WHERE dc.classid = 'pg_class'::regclass AND dc.objid = i.indexrelid
+                  AND dc.refclassid = 'pg_class'::regclass AND dc.refobjsubid > 0) AS columns,
+               EXISTS (
+                   SELECT 1
+                   FROM pg_index plain
+                   JOIN pg_depend dc ON dc.classid = 'pg_class'::regclass AND dc.objid = i.indexrelid
+                                    AND dc.refclassid = 'pg_class'::regclass AND dc.refobjid = i.indrelid
+                   WHERE plain.indrelid = i.indrelid
+                     AND plain.indexprs IS NULL
+                     AND plain.indkey[0] = dc.refobjsubid) AS has_plain_index
+        FROM pg_index i
+        JOIN pg_class c ON c.oid = i.indrelid
+        JOIN pg_namespace n ON n.oid = c.relnamespace
+        JOIN pg_depend d ON d.classid = 'pg_class'::regclass AND d.objid = i.indexrelid
+                        AND d.refclassid = 'pg_proc'::regclass
+        JOIN pg_proc p ON p.oid = d.refobjid
+        WHERE p.proname = ANY (conversions)
+          AND (schemas IS NULL OR n.nspname = ANY (schemas))
+          AND n.nspname NOT IN ('pg_catalog', 'information_schema')
+    LOOP
+        category := 'expression_index';
+        object_name := r.idx::text;
+        detail := format('%s (%s bytes)', r.def, r.size);
+        IF r.has_plain_index THEN
+            suggestion := format('Drop it: rewrite filters as ranges on %s, which already has a plain index',
+                                 r.columns);
+            estimated_savings_bytes := r.size;
+        ELSE
+            suggestion := format('Replace it with an index on %s and rewrite filters as '
+                                 'from_ethiopian_date() ranges on that column, which also serves Gregorian filters',
+                                 r.columns);
+            -- A btree on a timestamp takes about 24 bytes per row
+            estimated_savings_bytes := greatest(r.size - r.reltuples * 24, 0);
+        END IF;
+        RETURN NEXT;
+    END LOOP;
+
+    -- Queries comparing a conversion of a column, from pg_stat_statements
+    SELECT n.nspname INTO pgss_schema
+    FROM pg_extension e JOIN pg_namespace n ON n.oid = e.extnamespace
+    WHERE e.extname = 'pg_stat_statements';
+
+    IF pgss_schema IS NULL THEN
+        RETURN;
+    END IF;
+
+    time_column := CASE WHEN current_setting('server_version_num')::int >= 130000
+                        THEN 'total_exec_time' ELSE 'total_time' END;
+
+    BEGIN
+        FOR r IN EXECUTE format($q$
+            SELECT s.queryid, s.calls, s.%I AS total_ms, m[2] AS func,
+                   btrim(regexp_replace(m[3], '^.*,', '')) AS arg
+            FROM %I.pg_stat_statements s,
+                 regexp_matches(s.query,
+                     '\m(where|and|or|on)\s+(%s)\s*\(\s*([^()]*?)\s*\)\s*(=|<>|!=|<=|>=|<|>|between\M|in\M|like\M)',
+                     'gi') m
+            WHERE s.dbid = (SELECT oid FROM pg_database WHERE datname = current_database())
+            ORDER BY s.%I DESC$q$,
+            time_column, pgss_schema, array_to_string(conversions, '|'), time_column)
+        LOOP
+            category := 'non_sargable_filter';
+            object_name := format('queryid %s', r.queryid);
+            detail := format('%s(%s) compared in WHERE/ON; %s calls, %s ms total',
+                             r.func, r.arg, r.calls, round(r.total_ms::numeric, 1));
+            suggestion := format('Compare %1$s itself: %1$s >= from_ethiopian_date(''YYYY-MM-DD'') AND '
+                                 '%1$s < from_ethiopian_date(''YYYY-MM-DD'') can use an index on %1$s '
+                                 '(npm: inEthiopianMonth, inEthiopianYear, betweenEthiopian)',
+                                 r.arg);
+            estimated_savings_bytes := NULL;
+            RETURN NEXT;
+        END LOOP;
+    EXCEPTION WHEN object_not_in_prerequisite_state THEN
+        -- pg_stat_statements is installed but not in shared_preload_libraries
+        NULL;
+    END;
+END;
+$$;
+
+COMMENT ON FUNCTION ethiopian_calendar_advise(name[]) IS
+'Reports stored Ethiopian TEXT columns, expression indexes on conversion functions and non-sargable filters from pg_stat_statements, with suggested rewrites and estimated storage savings.';
+
+-- Function: ethiopian_recurrence_support(internal)
+-- 
+-- Planner support function for ethiopian_recurrence(): estimates the number
+-- of occurrences from a constant count, or from a constant rule and range.
+CREATE FUNCTION ethiopian_recurrence_support(internal)
+RETURNS internal
+AS 'MODULE_PATHNAME', 'ethiopian_recurrence_support'
+LANGUAGE C IMMUTABLE STRICT;
+
+-- Function: ethiopian_recurrence(text, timestamp, timestamp, integer)
+-- 
+-- Expands a recurring Ethiopian calendar schedule into Gregorian timestamps,
+-- from start (inclusive) until count occurrences or until (inclusive),
+-- whichever comes first. At least one limit is required. Occurrences keep
+-- the time of day of start.
+-- 
+-- Parameters:
+--   rule:  FREQ=DAILY|WEEKLY|MONTHLY|YEARLY, optional INTERVAL=n,
+--          MONTH=1-13 (YEARLY) and DAY=1-30 or -1 (last day), separated
+--          by ';'. DAY is clamped to the month's length (Pagumē: 5 or 6).
+--   start: Gregorian timestamp of the first possible occurrence
+--   until: last possible occurrence (optional)
+--   count: maximum number of occurrences (optional)
+-- 
+-- Returns: SETOF TIMESTAMP, in order
+CREATE FUNCTION ethiopian_recurrence(
+    rule text,
+    start timestamp,
+    until timestamp DEFAULT NULL,
+    count integer DEFAULT NULL)
+RETURNS SETOF timestamp
+AS 'MODULE_PATHNAME', 'ethiopian_recurrence'
+LANGUAGE C IMMUTABLE
+ROWS 100
+SUPPORT ethiopian_recurrence_support;
+
+COMMENT ON FUNCTION ethiopian_recurrence(text, timestamp, timestamp, integer) IS
+'Expands an Ethiopian recurrence rule (e.g. FREQ=MONTHLY;INTERVAL=2;DAY=30 or FREQ=YEARLY;MONTH=1;DAY=17) into Gregorian timestamps from start, limited by until and/or count. DAY is clamped to the month length.';
+
+-- Function: from_ethiopian_date(text[])
+-- 
+-- Batch form of from_ethiopian_date(text) for bulk ingest. Fixed-layout
+-- "YYYY-MM-DD" strings are parsed several digits at a time and the whole
+-- array is converted in one pass; other input falls back to the scalar parser.
+-- 
+-- Parameters:
+--   ethiopian_dates: array of Ethiopian calendar dates as text (format: YYYY-MM-DD)
+-- 
+-- Returns: TIMESTAMP[] (same dimensions; NULL elements stay NULL)
+CREATE FUNCTION from_ethiopian_date(text[])
+RETURNS timestamp[]
+AS 'MODULE_PATHNAME', 'from_ethiopian_date_array'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION from_ethiopian_date(text[]) IS
+'Converts an array of Ethiopian calendar date strings (YYYY-MM-DD) to Gregorian timestamps at midnight. NULL elements stay NULL; an invalid element raises the same error as from_ethiopian_date(text).';
+
+-- Function: ethiopian_calendar_verify_stats()
+-- 
+-- Counters of the shadow verification enabled by
+-- ethiopian_calendar.verify_sample_rate, for the current session. Mismatches
+-- are also written to the server log.
+-- 
+-- Returns: (sample_rate, checks, mismatches)
+CREATE FUNCTION ethiopian_calendar_verify_stats(
+    OUT sample_rate integer,
+    OUT checks bigint,
+    OUT mismatches bigint)
+RETURNS record
+AS 'MODULE_PATHNAME', 'ethiopian_calendar_verify_stats'
+LANGUAGE C STRICT VOLATILE;
+
+COMMENT ON FUNCTION ethiopian_calendar_verify_stats() IS
+'Returns this session''s sampled cross-checks of the conversion engines against the reference implementation, and how many differed.';
+
+-- Function: from_ethiopian_timestamp(text, boolean)
+-- 
+-- Converts an Ethiopian calendar date and time of day to a Gregorian timestamp
+-- in one pass, e.g. '2016-13-05 14:30:15.123'. The time is optional and may
+-- follow a space or 'T'.
+-- 
+-- Parameters:
+--   ethiopian_timestamp: text (format: YYYY-MM-DD[ HH:MI[:SS[.US]]])
+--   ethiopian_hours: time is on the Ethiopian clock, counted from 06:00
+--                    (00:00 is 06:00; 18:00-23:59 fall on the next Gregorian day)
+-- 
+-- Returns: TIMESTAMP (Gregorian calendar timestamp)
+CREATE FUNCTION from_ethiopian_timestamp(text, ethiopian_hours boolean DEFAULT false)
+RETURNS timestamp
+AS 'MODULE_PATHNAME', 'from_ethiopian_timestamp'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION from_ethiopian_timestamp(text, boolean) IS
+'Converts an Ethiopian calendar date and time (YYYY-MM-DD[ HH:MI[:SS[.US]]]) to a Gregorian timestamp. With ethiopian_hours the time is counted from 06:00.';
+
+-- Function: _ethiopian_normalize_date(text)
+-- 
+-- Same result as to_ethiopian_date(from_ethiopian_date(x)) without the
+-- intermediate timestamp. The planner substitutes it for that pair.
+CREATE FUNCTION _ethiopian_normalize_date(text)
+RETURNS text
+AS 'MODULE_PATHNAME', 'ethiopian_normalize_date'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION _ethiopian_normalize_date(text) IS
+'Internal: to_ethiopian_date(from_ethiopian_date(x)) in one step. Substituted by the planner.';
+
+-- Function: _ethiopian_day_trunc(timestamp)
+-- 
+-- Same result as from_ethiopian_date(to_ethiopian_date(ts)) without
+-- formatting and parsing text. The planner substitutes it for that pair.
+CREATE FUNCTION _ethiopian_day_trunc(timestamp)
+RETURNS timestamp
+AS 'MODULE_PATHNAME', 'ethiopian_day_trunc'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION _ethiopian_day_trunc(timestamp) IS
+'Internal: from_ethiopian_date(to_ethiopian_date(ts)) in one step. Substituted by the planner.';
+
+-- Function: ethiopian_conversion_support(internal)
+-- 
+-- Planner support function for the text conversions and their pg_ aliases:
+-- folds to_ethiopian_date(from_ethiopian_date(x)) into
+-- _ethiopian_normalize_date(x) and from_ethiopian_date(to_ethiopian_date(ts))
+-- into _ethiopian_day_trunc(ts), in any alias combination.
+CREATE FUNCTION ethiopian_conversion_support(internal)
+RETURNS internal
+AS 'MODULE_PATHNAME', 'ethiopian_conversion_support'
+LANGUAGE C IMMUTABLE STRICT;
+
+ALTER FUNCTION to_ethiopian_date(timestamp) SUPPORT ethiopian_conversion_support;
+ALTER FUNCTION pg_ethiopian_to_date(timestamp) SUPPORT ethiopian_conversion_support;
+ALTER FUNCTION to_ethiopian_date_text(timestamp) SUPPORT ethiopian_conversion_support;
+ALTER FUNCTION pg_ethiopian_to_date_text(timestamp) SUPPORT ethiopian_conversion_support;
+ALTER FUNCTION from_ethiopian_date(text) SUPPORT ethiopian_conversion_support;
+ALTER FUNCTION pg_ethiopian_from_date(text) SUPPORT ethiopian_conversion_support;
+
+-- Type: ethiopian_date_set
+-- 
+-- A compact set of days for per-entity calendars (working days, closures).
+-- Stored as a bitmap or as sorted day offsets, whichever is smaller, so a
+-- year of working days takes 66 bytes. The text form lists Gregorian ISO
+-- dates and ranges: {2024-01-01..2024-01-05,2024-01-08}
+CREATE TYPE ethiopian_date_set;
+
+CREATE FUNCTION ethiopian_date_set_in(cstring)
+RETURNS ethiopian_date_set
+AS 'MODULE_PATHNAME', 'ethiopian_date_set_in'
+LANGUAGE C IMMUTABLE STRICT;
+
+CREATE FUNCTION ethiopian_date_set_out(ethiopian_date_set)
+RETURNS cstring
+AS 'MODULE_PATHNAME', 'ethiopian_date_set_out'
+LANGUAGE C IMMUTABLE STRICT;
+
+CREATE FUNCTION ethiopian_date_set_recv(internal)
+RETURNS ethiopian_date_set
+AS 'MODULE_PATHNAME', 'ethiopian_date_set_recv'
+LANGUAGE C IMMUTABLE STRICT;
+
+CREATE FUNCTION ethiopian_date_set_send(ethiopian_date_set)
+RETURNS bytea
+AS 'MODULE_PATHNAME', 'ethiopian_date_set_send'
+LANGUAGE C IMMUTABLE STRICT;
+
+CREATE TYPE ethiopian_date_set (
+    INPUT = ethiopian_date_set_in,
+    OUTPUT = ethiopian_date_set_out,
+    RECEIVE = ethiopian_date_set_recv,
+    SEND = ethiopian_date_set_send,
+    INTERNALLENGTH = VARIABLE,
+    ALIGNMENT = int4,
+    STORAGE = extended
+);
+
+COMMENT ON TYPE ethiopian_date_set IS
+'Compact set of days (bitmap or sorted offsets). Text form: {2024-01-01..2024-01-05,2024-01-08}.';
+
+-- Function: ethiopian_date_set(date[])
+-- 
+-- Builds a set from a date array. NULL elements are ignored. Also used as
+-- the date[] -> ethiopian_date_set cast.
+-- 
+-- Returns: ETHIOPIAN_DATE_SET
+CREATE FUNCTION ethiopian_date_set(date[])
+RETURNS ethiopian_date_set
+AS 'MODULE_PATHNAME', 'ethiopian_date_set_from_dates'
+LANGUAGE C IMMUTABLE STRICT;
+
+CREATE CAST (date[] AS ethiopian_date_set)
+WITH FUNCTION ethiopian_date_set(date[]) AS ASSIGNMENT;
+
+COMMENT ON FUNCTION ethiopian_date_set(date[]) IS
+'Builds an ethiopian_date_set from a date array (NULL elements are ignored).';
+
+-- Function: ethiopian_date_set(text, text, integer[])
+-- 
+-- Builds a set from an inclusive Ethiopian date range, optionally keeping
+-- only some days of the week.
+-- 
+-- Parameters:
+--   from_date, to_date: Ethiopian calendar dates (format: YYYY-MM-DD)
+--   days_of_week: days to keep (0 = Sunday ... 6 = Saturday), NULL for all
+-- 
+-- Returns: ETHIOPIAN_DATE_SET (NULL if either bound is NULL)
+CREATE FUNCTION ethiopian_date_set(from_date text, to_date text, days_of_week integer[] DEFAULT NULL)
+RETURNS ethiopian_date_set
+AS 'MODULE_PATHNAME', 'ethiopian_date_set_from_range'
+LANGUAGE C IMMUTABLE;
+
+COMMENT ON FUNCTION ethiopian_date_set(text, text, integer[]) IS
+'Builds an ethiopian_date_set from an inclusive Ethiopian date range, optionally keeping only the given days of the week (0 = Sunday).';
+
+-- Function: ethiopian_date_set_count(ethiopian_date_set)
+-- 
+-- Returns: INTEGER (number of days in the set)
+CREATE FUNCTION ethiopian_date_set_count(ethiopian_date_set)
+RETURNS integer
+AS 'MODULE_PATHNAME', 'ethiopian_date_set_count'
+LANGUAGE C IMMUTABLE STRICT;
+
+COMMENT ON FUNCTION ethiopian_date_set_count(ethiopian_date_set) IS
+'Returns the number of days in an ethiopian_date_set.';
+
+-- Operators on ethiopian_date_set
+-- 
+--   set @> date, set @> timestamp, date <@ set: membership (O(1) for
+--                                                bitmaps, O(log n) otherwise)
+--   set | set: union
+--   set & set: intersection
+CREATE FUNCTION ethiopian_date_set_contains(ethiopian_date_set, date)
+RETURNS boolean
+AS 'MODULE_PATHNAME', 'ethiopian_date_set_contains'
+LANGUAGE C IMMUTABLE STRICT;
+
+CREATE FUNCTION ethiopian_date_set_contains(ethiopian_date_set, timestamp)
+RETURNS boolean
+AS 'MODULE_PATHNAME', 'ethiopian_date_set_contains_timestamp'
+LANGUAGE C IMMUTABLE STRICT;
+
+CREATE FUNCTION ethiopian_date_set_contained(date, ethiopian_date_set)
+RETURNS boolean
+AS 'MODULE_PATHNAME', 'ethiopian_date_set_contained'
+LANGUAGE C IMMUTABLE STRICT;
+
+CREATE FUNCTION ethiopian_date_set_union(ethiopian_date_set, ethiopian_date_set)
+RETURNS ethiopian_date_set
+AS 'MODULE_PATHNAME', 'ethiopian_date_set_union'
+LANGUAGE C IMMUTABLE STRICT;
+
+CREATE FUNCTION ethiopian_date_set_intersect(ethiopian_date_set, ethiopian_date_set)
+RETURNS ethiopian_date_set
+AS 'MODULE_PATHNAME', 'ethiopian_date_set_intersect'
+LANGUAGE C IMMUTABLE STRICT;
+
+CREATE OPERATOR @> (
+    LEFTARG = ethiopian_date_set,
+    RIGHTARG = date,
+    FUNCTION = ethiopian_date_set_contains,
+    COMMUTATOR = <@
+);
+
+CREATE OPERATOR <@ (
+    LEFTARG = date,
+    RIGHTARG = ethiopian_date_set,
+    FUNCTION = ethiopian_date_set_contained,
+    COMMUTATOR = @>
+);
+
+CREATE OPERATOR @> (
+    LEFTARG = ethiopian_date_set,
+    RIGHTARG = timestamp,
+    FUNCTION = ethiopian_date_set_contains
+);
+
+CREATE OPERATOR | (
+    LEFTARG = ethiopian_date_set,
+    RIGHTARG = ethiopian_date_set,
+    FUNCTION = ethiopian_date_set_union,
+    COMMUTATOR = |
+);
+
+CREATE OPERATOR & (
+    LEFTARG = ethiopian_date_set,
+    RIGHTARG = ethiopian_date_set,
+    FUNCTION = ethiopian_date_set_intersect,
+    COMMUTATOR = &
+);
+
+-- Function: ethiopian_calendar_parse_cache_stats()
+-- 
+-- Counters of the from_ethiopian_date() parse cache for the current
+-- session. Each call site caches up to 4096 distinct input strings.
+-- 
+-- Returns: (hits, misses, evictions, hit_ratio)
+CREATE FUNCTION ethiopian_calendar_parse_cache_stats(
+    OUT hits bigint,
+    OUT misses bigint,
+    OUT evictions bigint,
+    OUT hit_ratio double precision)
+RETURNS record
+AS 'MODULE_PATHNAME', 'ethiopian_calendar_parse_cache_stats'
+LANGUAGE C STRICT VOLATILE;
+
+COMMENT ON FUNCTION ethiopian_calendar_parse_cache_stats() IS
+'Returns this session''s from_ethiopian_date() parse cache hits, misses, evictions and hit ratio.';
+
+-- Example usage with generated columns:
+-- 
+-- Using TIMESTAMP type for Ethiopian calendar dates:
+-- 
+-- CREATE TABLE example_table (
+--     id SERIAL PRIMARY KEY,
+--     created_at TIMESTAMP DEFAULT NOW(),
+--     created_at_ethiopian TIMESTAMP GENERATED ALWAYS AS (to_ethiopian_timestamp(created_at)) STORED,
+--     updated_at TIMESTAMP DEFAULT NOW(),
+--     updated_at_ethiopian TIMESTAMP GENERATED ALWAYS AS (to_ethiopian_timestamp(updated_at)) STORED
+-- );
+-- 
+-- Using TEXT type (alternative):
+-- 
+-- CREATE TABLE example_table (
+--     id SERIAL PRIMARY KEY,
+--     created_at TIMESTAMP DEFAULT NOW(),
+--     created_at_ethiopian TEXT GENERATED ALWAYS AS (to_ethiopian_date(created_at)) STORED
+-- );
+-- 
+-- Using the "C"-collated text domain (cheaper sorts and index builds):
+-- 
+-- CREATE TABLE example_table (
+--     id SERIAL PRIMARY KEY,
+--     created_at TIMESTAMP DEFAULT NOW(),
+--     created_at_ethiopian ethiopian_date_text GENERATED ALWAYS AS (to_ethiopian_date_text(created_at)) STORED
+-- );
+-- 
+-- Using current_ethiopian_date() for default values:
+-- 
+-- CREATE TABLE example_table (
+--     id SERIAL PRIMARY KEY,
+--     date_ethiopian TEXT DEFAULT current_ethiopian_date()
+-- );
+
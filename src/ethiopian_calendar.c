@@ -18,249 +18,549 @@
  */
 
 #include "postgres.h"
+
+#include <ctype.h>
+#include <math.h>
+
 #include "fmgr.h"
+#include "funcapi.h"
+#include "access/htup_details.h"
+#include "catalog/pg_type.h"
+#include "executor/executor.h"
+#include "lib/stringinfo.h"
+#include "libpq/pqformat.h"
+#include "nodes/makefuncs.h"
+#include "nodes/nodeFuncs.h"
+#include "nodes/supportnodes.h"
+#include "optimizer/optimizer.h"
+#include "parser/parse_func.h"
+#include "utils/array.h"
 #include "utils/date.h"
+#include "utils/fmgroids.h"
+#include "utils/guc.h"
 #include "utils/timestamp.h"
 #include "utils/builtins.h"
+#include "utils/lsyscache.h"
+
+#include "ethiopian_calendar_api.h"
+#include "ethiopian_core.h"
+#include "ethiopian_engine.h"
+#include "ethiopian_stats.h"
 
 PG_MODULE_MAGIC;
 
-/*
- * Ethiopian calendar epoch: August 29, 8 CE in Gregorian calendar
- * This corresponds to JDN 1724221
- */
-#define ETHIOPIAN_EPOCH 1724221
+void _PG_init(void);
+extern PGDLLEXPORT const EthiopianCalendarApi *ethiopian_calendar_get_api(void);
 
 /*
- * Convert Gregorian date to Julian Day Number
- * 
- * Algorithm from "Calendrical Calculations" by Dershowitz & Reingold
+ * Convert Gregorian date components to PostgreSQL DATE (DateADT)
  * 
  * Parameters:
  *   year, month, day: Gregorian calendar components
  * 
- * Returns: Julian Day Number
+ * Returns: PostgreSQL DATE value (DateADT)
  */
-static int
-gregorian_to_jdn(int year, int month, int day)
+static DateADT
+gregorian_to_dateadt(int year, int month, int day)
+{
+    int jdn;
+    DateADT date_val;
+    
+    /* Convert Gregorian date to Julian Day Number */
+    jdn = gregorian_to_jdn(year, month, day);
+    
+    /* Convert JDN to DateADT (days since 2000-01-01) */
+    date_val = jdn - POSTGRES_EPOCH_JDATE;
+    
+    return date_val;
+}
+
+/*
+ * Error for infinite timestamps, which have no Ethiopian date
+ */
+pg_noinline static void
+report_timestamp_not_finite(void)
 {
-    int a, y, m, jdn;
+    ereport(ERROR,
+            (errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
+             errmsg("timestamp out of range")));
+}
 
-    /* Adjust for month/year if month is January or February */
-    a = (14 - month) / 12;
-    y = year + 4800 - a;
-    m = month + 12 * a - 3;
+/*
+ * Convert a Gregorian timestamp to the Julian Day Number of its date
+ * 
+ * Same result as timestamp_date() without the nested fmgr call: the date is
+ * the floor of the microsecond count, so times before 2000-01-01 round down.
+ * Infinite timestamps are rejected.
+ */
+static inline int
+timestamp_to_jdn(Timestamp timestamp_val)
+{
+    Timestamp days;
 
-    /* Calculate Julian Day Number */
-    jdn = day + (153 * m + 2) / 5 + 365 * y + y / 4 - y / 100 + y / 400 - 32045;
+    if (unlikely(TIMESTAMP_NOT_FINITE(timestamp_val)))
+        report_timestamp_not_finite();
 
-    return jdn;
+    days = timestamp_val / USECS_PER_DAY;
+    if (timestamp_val % USECS_PER_DAY < 0)
+        days--;
+
+    return (int) days + POSTGRES_EPOCH_JDATE;
 }
 
 /*
- * Convert Julian Day Number to Gregorian date
- * 
- * Algorithm from "Calendrical Calculations" by Dershowitz & Reingold
+ * Time of day of a finite timestamp, in microseconds (0 .. USECS_PER_DAY - 1)
+ */
+static inline TimeOffset
+timestamp_time_of_day(Timestamp timestamp_val)
+{
+    TimeOffset time_offset = timestamp_val % USECS_PER_DAY;
+
+    return (time_offset < 0) ? time_offset + USECS_PER_DAY : time_offset;
+}
+
+/*
+ * Error for dates before the Ethiopian calendar epoch
  * 
- * Parameters:
- *   jdn: Julian Day Number
- *   year, month, day: Output parameters for Gregorian date components
+ * Kept out of line so the conversion functions carry no error-reporting
+ * setup on their success path.
+ */
+pg_noinline static void
+report_before_epoch(void)
+{
+    ereport(ERROR,
+            (errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
+             errmsg("date is before Ethiopian calendar epoch (August 29, 8 CE)")));
+}
+
+/*
+ * Build a text datum holding an Ethiopian date, without a cstring copy
+ */
+static inline text *
+ethiopian_date_text(int year, int month, int day)
+{
+    text *result = (text *) palloc(VARHDRSZ + ETHIOPIAN_DATE_BUFLEN);
+
+    SET_VARSIZE(result, VARHDRSZ + format_ethiopian_date(VARDATA(result), year, month, day));
+    return result;
+}
+
+/*
+ * Conversion engines (ethiopian_calendar.engine)
+ *
+ * Alternative JDN -> Ethiopian date kernels that give exactly the same
+ * results as jdn_to_ethiopian(). The per-row SQL functions call through
+ * engine_jdn_to_ethiopian, which the GUC assign hook points at the selected
+ * kernel, so the setting costs nothing per row and a session or role can be
+ * switched to another kernel (and back) without a reload. Statistics are
+ * kept per engine (ethiopian_stats.c) so the kernels can be compared on real
+ * workloads. The C API and the bucket/recurrence code always use the
+ * reference kernel.
+ */
+
+typedef void (*EthiopianFromJdnFunc) (int jdn, int *year, int *month, int *day);
+
+/*
+ * Arithmetic kernel: one division for the four-year cycle, multiply-shift
+ * for the year (r / 365) and month (day_of_year / 30), no branches
  */
 static void
-jdn_to_gregorian(int jdn, int *year, int *month, int *day)
+jdn_to_ethiopian_fast(int jdn, int *year, int *month, int *day)
 {
-    int a, b, c, d, e, m;
+    int days_since_epoch = jdn - ETHIOPIAN_EPOCH;
+    int era = days_since_epoch / 1461;
+    int remainder = days_since_epoch - era * 1461;
+    int year_of_era = (remainder * 1437) >> 19;         /* remainder / 365, exact up to 1460 */
+    int day_of_year;
+    int month_index;
+
+    /* The 1461st day of the cycle belongs to the 4th year, as in jdn_to_ethiopian() */
+    year_of_era -= year_of_era >> 2;
+    day_of_year = remainder - year_of_era * 365;
 
-    a = jdn + 32044;
-    b = (4 * a + 3) / 146097;
-    c = a - (b * 146097) / 4;
-    d = (4 * c + 3) / 1461;
-    e = c - (1461 * d) / 4;
-    m = (5 * e + 2) / 153;
+    /* That day is clamped to Pagumē 5 by the reference kernel */
+    day_of_year -= day_of_year / 365;
 
-    *day = e - (153 * m + 2) / 5 + 1;
-    *month = m + 3 - 12 * (m / 10);
-    *year = b * 100 + d - 4800 + (m / 10);
+    month_index = (day_of_year * 547) >> 14;             /* day_of_year / 30, exact up to 365 */
+
+    *year = 4 * era + year_of_era + 1;
+    *month = month_index + 1;
+    *day = day_of_year - month_index * 30 + 1;
 }
 
 /*
- * Convert Julian Day Number to Ethiopian calendar date
- * 
- * Algorithm from "Calendrical Calculations" by Dershowitz & Reingold
- * Chapter 4: Ethiopian Calendar
- * 
- * The Ethiopian calendar has:
- *   - 12 months of 30 days each (months 1-12: Meskerem, Tikimt, Hidar, Tahsas, etc.)
- *   - 1 month of 5 or 6 days (month 13, Pagumē)
- *   - Leap years have 6 days in month 13, regular years have 5
- *   - Leap years occur every 4 years (years where year % 4 == 3)
- *   - Year 1 in Ethiopian calendar started on August 29, 8 CE (Gregorian)
- * 
- * Formula from Calendrical Calculations:
- *   era = floor((jdn - ETHIOPIAN_EPOCH) / 1461)
- *   year_of_era = floor(((jdn - ETHIOPIAN_EPOCH) mod 1461) / 365)
- *   day_of_year = ((jdn - ETHIOPIAN_EPOCH) mod 1461) mod 365
- *   
- *   If year_of_era == 4, then year_of_era = 3 and day_of_year = 365
- *   
- *   year = 4 * era + year_of_era + 1
- *   
- *   month = floor(day_of_year / 30) + 1  (if day_of_year < 360)
- *   day = (day_of_year mod 30) + 1
- *   
- *   If day_of_year >= 360, then month = 13 and day = day_of_year - 360 + 1
- * 
- * Parameters:
- *   jdn: Julian Day Number
- *   year, month, day: Output parameters for Ethiopian date components
+ * Lookup kernel: (year of cycle, month, day) for every day of a four-year
+ * cycle, packed as year_of_era << 9 | month << 5 | day and built from the
+ * reference kernel the first time the engine is selected
  */
+#define ETHIOPIAN_CYCLE_DAYS 1461
+
+static uint16 ethiopian_cycle_table[ETHIOPIAN_CYCLE_DAYS];
+static bool ethiopian_cycle_table_built = false;
+
 static void
-jdn_to_ethiopian(int jdn, int *year, int *month, int *day)
+build_ethiopian_cycle_table(void)
 {
-    int era, year_of_era, day_of_year;
-    int days_since_epoch;
-    
-    /* Calculate days since Ethiopian epoch */
-    days_since_epoch = jdn - ETHIOPIAN_EPOCH;
-    
-    /* Calculate era (4-year cycles) */
-    era = days_since_epoch / 1461;
-    
-    /* Calculate year within the era (0-3) */
-    year_of_era = (days_since_epoch % 1461) / 365;
-    
-    /* Calculate day of year (0-365) */
-    day_of_year = (days_since_epoch % 1461) % 365;
-    
-    /* Handle the 4th year of the era (leap year with 366 days) */
-    if (year_of_era == 4)
+    int i;
+
+    for (i = 0; i < ETHIOPIAN_CYCLE_DAYS; i++)
     {
-        year_of_era = 3;
-        day_of_year = 365;
+        int year, month, day;
+
+        jdn_to_ethiopian(ETHIOPIAN_EPOCH + i, &year, &month, &day);
+        ethiopian_cycle_table[i] = (uint16) ((year - 1) << 9 | month << 5 | day);
     }
-    
-    /* Calculate Ethiopian year */
-    *year = 4 * era + year_of_era + 1;
-    
-    /* Calculate month and day */
-    if (day_of_year < 360)
+    ethiopian_cycle_table_built = true;
+}
+
+static void
+jdn_to_ethiopian_lookup(int jdn, int *year, int *month, int *day)
+{
+    int days_since_epoch = jdn - ETHIOPIAN_EPOCH;
+    int era = days_since_epoch / ETHIOPIAN_CYCLE_DAYS;
+    int entry = ethiopian_cycle_table[days_since_epoch - era * ETHIOPIAN_CYCLE_DAYS];
+
+    *year = 4 * era + (entry >> 9) + 1;
+    *month = (entry >> 5) & 0x0F;
+    *day = entry & 0x1F;
+}
+
+static void
+jdn_to_ethiopian_reference(int jdn, int *year, int *month, int *day)
+{
+    jdn_to_ethiopian(jdn, year, month, day);
+}
+
+static const struct config_enum_entry engine_options[] = {
+    {"auto", ETHIOPIAN_ENGINE_AUTO, false},
+    {"reference", ETHIOPIAN_ENGINE_REFERENCE, false},
+    {"fast", ETHIOPIAN_ENGINE_FAST, false},
+    {"lookup", ETHIOPIAN_ENGINE_LOOKUP, false},
+    {NULL, 0, false}
+};
+
+/* What auto resolves to */
+#define ETHIOPIAN_ENGINE_DEFAULT ETHIOPIAN_ENGINE_FAST
+
+static int engine_setting = ETHIOPIAN_ENGINE_AUTO;
+static int engine_resolved = ETHIOPIAN_ENGINE_DEFAULT;
+
+/* The selected kernel, and what the per-row functions call */
+static EthiopianFromJdnFunc engine_kernel = jdn_to_ethiopian_fast;
+static EthiopianFromJdnFunc engine_jdn_to_ethiopian = jdn_to_ethiopian_fast;
+
+/*
+ * Shadow verification (ethiopian_calendar.verify_sample_rate)
+ *
+ * One call in verify_sample_rate is repeated with the reference code
+ * (jdn_to_ethiopian(), sscanf() + ethiopian_to_jdn()) and any difference is
+ * counted and logged. For timestamp conversions the check lives in a wrapper
+ * kernel that is only installed while sampling is on; the parser, including
+ * parse cache hits, tests the rate before counting down. Counters are per
+ * backend.
+ */
+static int verify_sample_rate = 0;
+static int verify_countdown = 0;
+static int64 verify_checks = 0;
+static int64 verify_mismatches = 0;
+
+/*
+ * Count down to the next sampled call; call only while sampling is on
+ */
+static inline bool
+verify_sample(void)
+{
+    if (--verify_countdown > 0)
+        return false;
+
+    verify_countdown = verify_sample_rate;
+    verify_checks++;
+    return true;
+}
+
+pg_noinline static void
+report_verify_mismatch(const char *function, const char *input,
+                       const char *result, const char *expected)
+{
+    verify_mismatches++;
+    ereport(LOG,
+            (errmsg("ethiopian_calendar: %s result differs from the reference implementation",
+                    function),
+             errdetail("Input %s gave %s with engine \"%s\", reference gives %s.",
+                       input, result, ethiopian_engine_name(engine_resolved), expected)));
+}
+
+static void
+jdn_to_ethiopian_verified(int jdn, int *year, int *month, int *day)
+{
+    int ref_year, ref_month, ref_day;
+
+    engine_kernel(jdn, year, month, day);
+
+    if (!verify_sample())
+        return;
+
+    jdn_to_ethiopian(jdn, &ref_year, &ref_month, &ref_day);
+    if (*year != ref_year || *month != ref_month || *day != ref_day)
     {
-        /* Months 1-12: each has 30 days */
-        *month = day_of_year / 30 + 1;
-        *day = (day_of_year % 30) + 1;
+        char input[32];
+        char result[ETHIOPIAN_DATE_BUFLEN];
+        char expected[ETHIOPIAN_DATE_BUFLEN];
+
+        snprintf(input, sizeof(input), "JDN %d", jdn);
+        format_ethiopian_date(result, *year, *month, *day);
+        format_ethiopian_date(expected, ref_year, ref_month, ref_day);
+        report_verify_mismatch("jdn_to_ethiopian", input, result, expected);
     }
-    else
+}
+
+static void
+install_engine(void)
+{
+    engine_jdn_to_ethiopian = (verify_sample_rate > 0) ? jdn_to_ethiopian_verified : engine_kernel;
+}
+
+/*
+ * Assign hook for ethiopian_calendar.engine: resolve the kernel once
+ */
+static void
+assign_engine(int newval, void *extra)
+{
+    engine_resolved = (newval == ETHIOPIAN_ENGINE_AUTO) ? ETHIOPIAN_ENGINE_DEFAULT : newval;
+
+    switch (engine_resolved)
     {
-        /* Month 13 (Pagumē): 5 or 6 days */
-        int is_leap;
-        int max_days;
-        
-        *month = 13;
-        *day = day_of_year - 360 + 1;
-        
-        /* Validate: month 13 has 5 days in regular years, 6 in leap years */
-        /* Leap years: year % 4 == 3 */
-        is_leap = (*year % 4 == 3);
-        max_days = is_leap ? 6 : 5;
-        
-        if (*day > max_days)
-        {
-            *day = max_days;
-        }
+        case ETHIOPIAN_ENGINE_REFERENCE:
+            engine_kernel = jdn_to_ethiopian_reference;
+            break;
+        case ETHIOPIAN_ENGINE_LOOKUP:
+            if (!ethiopian_cycle_table_built)
+                build_ethiopian_cycle_table();
+            engine_kernel = jdn_to_ethiopian_lookup;
+            break;
+        default:
+            engine_kernel = jdn_to_ethiopian_fast;
+            break;
     }
+    install_engine();
 }
 
 /*
- * Convert Ethiopian calendar date to Julian Day Number
- * 
- * Algorithm from "Calendrical Calculations" by Dershowitz & Reingold
- * Inverse of jdn_to_ethiopian
- * 
- * Formula:
- *   era = floor((year - 1) / 4)
- *   year_of_era = (year - 1) mod 4
- *   
- *   If month <= 12:
- *     day_of_year = (month - 1) * 30 + day - 1
- *   Else (month == 13):
- *     day_of_year = 360 + day - 1
- *   
- *   jdn = ETHIOPIAN_EPOCH + era * 1461 + year_of_era * 365 + day_of_year
- * 
- * Parameters:
- *   year, month, day: Ethiopian calendar components
- * 
- * Returns: Julian Day Number
+ * Assign hook for ethiopian_calendar.verify_sample_rate
+ */
+static void
+assign_verify_sample_rate(int newval, void *extra)
+{
+    verify_sample_rate = newval;
+    verify_countdown = newval;
+    install_engine();
+}
+
+int
+ethiopian_engine_current(void)
+{
+    return engine_resolved;
+}
+
+const char *
+ethiopian_engine_name(int engine)
+{
+    const struct config_enum_entry *option;
+
+    for (option = engine_options; option->name != NULL; option++)
+    {
+        if (option->val == engine)
+            return option->name;
+    }
+    return "unknown";
+}
+
+/*
+ * C API for other extensions (see ethiopian_calendar_api.h)
+ *
+ * These work directly on DateADT day numbers and report invalid input by
+ * return value instead of raising errors, so callers can use them in tight
+ * loops and decide how to handle bad values themselves.
  */
+
+static bool
+api_is_leap_year(int year)
+{
+    return year % 4 == 3;
+}
+
+static bool
+api_date_to_ethiopian(DateADT date, int *year, int *month, int *day)
+{
+    /* Also rejects DATEVAL_NOBEGIN/DATEVAL_NOEND */
+    if (date < ETHIOPIAN_EPOCH - POSTGRES_EPOCH_JDATE ||
+        date >= DATE_END_JULIAN - POSTGRES_EPOCH_JDATE)
+        return false;
+
+    jdn_to_ethiopian(date + POSTGRES_EPOCH_JDATE, year, month, day);
+    return true;
+}
+
+static bool
+api_ethiopian_to_date(int year, int month, int day, DateADT *date)
+{
+    int64 jdn;
+
+    if (!ethiopian_date_is_valid(year, month, day))
+        return false;
+
+    /* Same arithmetic as ethiopian_to_jdn(), in 64 bits to catch huge years */
+    jdn = (int64) ETHIOPIAN_EPOCH + (int64) ((year - 1) / 4) * 1461 +
+        ((year - 1) % 4) * 365 + (month - 1) * 30 + (day - 1);
+    if (jdn >= DATE_END_JULIAN)
+        return false;
+
+    *date = (DateADT) (jdn - POSTGRES_EPOCH_JDATE);
+    return true;
+}
+
 static int
-ethiopian_to_jdn(int year, int month, int day)
+api_format_date(DateADT date, char *buf)
 {
-    int era, year_of_era, day_of_year, jdn;
-    
-    /* Calculate era (4-year cycles) and year within era */
-    era = (year - 1) / 4;
-    year_of_era = (year - 1) % 4;
-    
-    /* Calculate day of year (0-based) */
-    if (month <= 12)
+    int year, month, day;
+
+    if (!api_date_to_ethiopian(date, &year, &month, &day))
+        return 0;
+
+    return format_ethiopian_date(buf, year, month, day);
+}
+
+static int
+api_dates_to_ethiopian(const DateADT *dates, int count,
+                       int *years, int *months, int *days)
+{
+    int invalid = 0;
+    int i;
+
+    for (i = 0; i < count; i++)
     {
-        /* Months 1-12: each has 30 days */
-        day_of_year = (month - 1) * 30 + (day - 1);
+        DateADT date = dates[i];
+
+        if (date < ETHIOPIAN_EPOCH - POSTGRES_EPOCH_JDATE ||
+            date >= DATE_END_JULIAN - POSTGRES_EPOCH_JDATE)
+        {
+            years[i] = months[i] = days[i] = 0;
+            invalid++;
+            continue;
+        }
+
+        jdn_to_ethiopian(date + POSTGRES_EPOCH_JDATE, &years[i], &months[i], &days[i]);
     }
-    else
+
+    return invalid;
+}
+
+static int
+api_ethiopian_to_dates(const int *years, const int *months, const int *days,
+                       int count, DateADT *dates)
+{
+    int invalid = 0;
+    int i;
+
+    for (i = 0; i < count; i++)
     {
-        /* Month 13 (Pagumē): days 360-365 (or 360-366 in leap years) */
-        day_of_year = 360 + (day - 1);
+        if (!api_ethiopian_to_date(years[i], months[i], days[i], &dates[i]))
+        {
+            DATE_NOBEGIN(dates[i]);
+            invalid++;
+        }
     }
-    
-    /* Calculate Julian Day Number */
-    jdn = ETHIOPIAN_EPOCH + era * 1461 + year_of_era * 365 + day_of_year;
-    
-    return jdn;
+
+    return invalid;
 }
 
+static const EthiopianCalendarApi ethiopian_calendar_api = {
+    ETHIOPIAN_CALENDAR_API_VERSION,
+    sizeof(EthiopianCalendarApi),
+    ETHIOPIAN_EPOCH - POSTGRES_EPOCH_JDATE,
+    api_date_to_ethiopian,
+    api_ethiopian_to_date,
+    api_is_leap_year,
+    api_format_date,
+    api_dates_to_ethiopian,
+    api_ethiopian_to_dates
+};
+
 /*
- * Convert PostgreSQL DATE (DateADT) to Gregorian date components
- * DateADT is stored as days since 2000-01-01 (POSTGRES_EPOCH_JDATE = 2451545)
- * 
- * Parameters:
- *   date_val: PostgreSQL DATE value (DateADT)
- *   year, month, day: Output parameters for Gregorian date components
+ * Return the C API struct; looked up by name with load_external_function()
  */
-static void
-dateadt_to_gregorian(DateADT date_val, int *year, int *month, int *day)
+const EthiopianCalendarApi *
+ethiopian_calendar_get_api(void)
 {
-    int jdn;
-    
-    /* Convert DateADT to Julian Day Number */
-    /* DateADT is days since 2000-01-01, which is JDN 2451545 */
-    jdn = date_val + POSTGRES_EPOCH_JDATE;
-    
-    /* Convert JDN to Gregorian date */
-    jdn_to_gregorian(jdn, year, month, day);
+    return &ethiopian_calendar_api;
 }
 
 /*
- * Convert Gregorian date components to PostgreSQL DATE (DateADT)
+ * Module load callback
+ *
+ * Publishes the C API through a rendezvous variable, defines
+ * ethiopian_calendar.engine and ethiopian_calendar.verify_sample_rate and
+ * sets up per-query statistics (ethiopian_stats.c), which are only active when the library is
+ * loaded through shared_preload_libraries.
+ */
+void
+_PG_init(void)
+{
+    const EthiopianCalendarApi **api_ptr;
+
+    api_ptr = (const EthiopianCalendarApi **) find_rendezvous_variable(ETHIOPIAN_CALENDAR_API_RENDEZVOUS);
+    *api_ptr = &ethiopian_calendar_api;
+
+    DefineCustomEnumVariable("ethiopian_calendar.engine",
+                             "Selects the kernel used to convert timestamps to Ethiopian dates.",
+                             "All engines give the same results; auto picks the one recommended for this build.",
+                             &engine_setting,
+                             ETHIOPIAN_ENGINE_AUTO,
+                             engine_options,
+                             PGC_USERSET,
+                             0,
+                             NULL, assign_engine, NULL);
+
+    DefineCustomIntVariable("ethiopian_calendar.verify_sample_rate",
+                            "Re-checks one in this many conversions against the reference implementation.",
+                            "Mismatches are logged and counted in ethiopian_calendar_verify_stats(). 0 turns checking off.",
+                            &verify_sample_rate,
+                            0,
+                            0,
+                            INT_MAX,
+                            PGC_SUSET,
+                            0,
+                            NULL, assign_verify_sample_rate, NULL);
+
+    ethiopian_stats_init();
+}
+
+/*
+ * PostgreSQL function: ethiopian_calendar_verify_stats()
  * 
- * Parameters:
- *   year, month, day: Gregorian calendar components
+ * Shadow verification counters of this backend.
  * 
- * Returns: PostgreSQL DATE value (DateADT)
+ * Returns: RECORD (sample_rate INTEGER, checks BIGINT, mismatches BIGINT)
  */
-static DateADT
-gregorian_to_dateadt(int year, int month, int day)
+PG_FUNCTION_INFO_V1(ethiopian_calendar_verify_stats);
+
+Datum
+ethiopian_calendar_verify_stats(PG_FUNCTION_ARGS)
 {
-    int jdn;
-    DateADT date_val;
-    
-    /* Convert Gregorian date to Julian Day Number */
-    jdn = gregorian_to_jdn(year, month, day);
-    
-    /* Convert JDN to DateADT (days since 2000-01-01) */
-    date_val = jdn - POSTGRES_EPOCH_JDATE;
-    
-    return date_val;
+    TupleDesc tupdesc;
+    Datum values[3];
+    bool nulls[3] = {false, false, false};
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("function returning record called in context that cannot accept type record")));
+
+    values[0] = Int32GetDatum(verify_sample_rate);
+    values[1] = Int64GetDatum(verify_checks);
+    values[2] = Int64GetDatum(verify_mismatches);
+
+    PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(BlessTupleDesc(tupdesc), values, nulls)));
 }
 
 /*
@@ -277,44 +577,16 @@ PG_FUNCTION_INFO_V1(to_ethiopian_date);
 Datum
 to_ethiopian_date(PG_FUNCTION_ARGS)
 {
-    Timestamp timestamp_val;
-    DateADT date_val;
+    int jdn = timestamp_to_jdn(PG_GETARG_TIMESTAMP(0));
     int eth_year, eth_month, eth_day;
-    int greg_year, greg_month, greg_day;
-    int jdn;
-    char result_text[32];
-    text *result;
-    
-    /* Handle NULL input */
-    if (PG_ARGISNULL(0))
-        PG_RETURN_NULL();
-    
-    /* Get the timestamp value */
-    timestamp_val = PG_GETARG_TIMESTAMP(0);
-    
-    /* Extract date part (discard time) */
-    date_val = DatumGetDateADT(DirectFunctionCall1(timestamp_date, TimestampGetDatum(timestamp_val)));
-    
-    /* Convert PostgreSQL DATE to Gregorian components */
-    dateadt_to_gregorian(date_val, &greg_year, &greg_month, &greg_day);
-
-    /* Convert Gregorian date to Julian Day Number */
-    jdn = gregorian_to_jdn(greg_year, greg_month, greg_day);
 
     /* Reject dates before Ethiopian calendar epoch (August 29, 8 CE = JDN 1724221) */
-    if (jdn < ETHIOPIAN_EPOCH)
-        ereport(ERROR,
-                (errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
-                 errmsg("date is before Ethiopian calendar epoch (August 29, 8 CE)")));
+    if (unlikely(jdn < ETHIOPIAN_EPOCH))
+        report_before_epoch();
 
-    /* Convert JDN to Ethiopian calendar */
-    jdn_to_ethiopian(jdn, &eth_year, &eth_month, &eth_day);
+    engine_jdn_to_ethiopian(jdn, &eth_year, &eth_month, &eth_day);
 
-    /* Format as text: "YYYY-MM-DD" */
-    snprintf(result_text, sizeof(result_text), "%04d-%02d-%02d", eth_year, eth_month, eth_day);
-    
-    result = cstring_to_text(result_text);
-    PG_RETURN_TEXT_P(result);
+    PG_RETURN_TEXT_P(ethiopian_date_text(eth_year, eth_month, eth_day));
 }
 
 /*
@@ -333,93 +605,76 @@ PG_FUNCTION_INFO_V1(to_ethiopian_datetime);
 Datum
 to_ethiopian_datetime(PG_FUNCTION_ARGS)
 {
-    Timestamp timestamp_val;
-    DateADT date_val;
+    Timestamp timestamp_val = PG_GETARG_TIMESTAMP(0);
+    int jdn = timestamp_to_jdn(timestamp_val);
     int eth_year, eth_month, eth_day;
-    int greg_year, greg_month, greg_day;
-    int jdn;
-    DateADT eth_date;
-    Timestamp result_timestamp;
-    TimeOffset time_offset;
-    
-    /* Handle NULL input */
-    if (PG_ARGISNULL(0))
-        PG_RETURN_NULL();
-    
-    /* Get the timestamp value */
-    timestamp_val = PG_GETARG_TIMESTAMP(0);
-    
-    /* Extract date and time components */
-    date_val = DatumGetDateADT(DirectFunctionCall1(timestamp_date, TimestampGetDatum(timestamp_val)));
-    time_offset = timestamp_val - (date_val * USECS_PER_DAY);
-
-    /* Convert PostgreSQL DATE to Gregorian components */
-    dateadt_to_gregorian(date_val, &greg_year, &greg_month, &greg_day);
-
-    /* Convert Gregorian date to Julian Day Number */
-    jdn = gregorian_to_jdn(greg_year, greg_month, greg_day);
 
     /* Reject dates before Ethiopian calendar epoch (August 29, 8 CE = JDN 1724221) */
-    if (jdn < ETHIOPIAN_EPOCH)
-        ereport(ERROR,
-                (errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
-                 errmsg("date is before Ethiopian calendar epoch (August 29, 8 CE)")));
+    if (unlikely(jdn < ETHIOPIAN_EPOCH))
+        report_before_epoch();
 
-    /* Convert JDN to Ethiopian calendar */
-    jdn_to_ethiopian(jdn, &eth_year, &eth_month, &eth_day);
+    engine_jdn_to_ethiopian(jdn, &eth_year, &eth_month, &eth_day);
 
     /*
-     * Encode Ethiopian date components into a Gregorian-shaped DateADT so the
-     * timestamp displays Ethiopian year/month/day values.
+     * Encode Ethiopian date components into a Gregorian-shaped date so the
+     * timestamp displays Ethiopian year/month/day values, and keep the
+     * original time of day.
      */
-    eth_date = gregorian_to_dateadt(eth_year, eth_month, eth_day);
-
-    /* Combine Ethiopian date with original time */
-    result_timestamp = (eth_date * USECS_PER_DAY) + time_offset;
-
-    PG_RETURN_TIMESTAMP(result_timestamp);
+    PG_RETURN_TIMESTAMP((Timestamp) gregorian_to_dateadt(eth_year, eth_month, eth_day) * USECS_PER_DAY +
+                        timestamp_time_of_day(timestamp_val));
 }
 
 /*
- * PostgreSQL function: from_ethiopian_date(text)
- * 
- * Converts an Ethiopian calendar date string to a Gregorian timestamp.
- * The input should be in format "YYYY-MM-DD" (Ethiopian calendar).
- * 
- * Parameters:
- *   ethiopian_date: Ethiopian calendar date as text (format: YYYY-MM-DD)
- * 
- * Returns: TIMESTAMP (Gregorian calendar timestamp at midnight)
+ * Shadow check of the SWAR parser against sscanf() (see verify_sample())
  */
-PG_FUNCTION_INFO_V1(from_ethiopian_date);
+pg_noinline static void
+verify_fixed_ethiopian_date(const char *str, int len, int year, int month, int day)
+{
+    char *date_str = pnstrdup(str, len);
+    int ref_year, ref_month, ref_day;
 
-Datum
-from_ethiopian_date(PG_FUNCTION_ARGS)
+    if (sscanf(date_str, "%d-%d-%d", &ref_year, &ref_month, &ref_day) != 3 ||
+        year != ref_year || month != ref_month || day != ref_day)
+    {
+        char result[32];
+        char expected[32];
+
+        snprintf(result, sizeof(result), "%d-%d-%d", year, month, day);
+        snprintf(expected, sizeof(expected), "%d-%d-%d", ref_year, ref_month, ref_day);
+        report_verify_mismatch("from_ethiopian_date", quote_literal_cstr(date_str), result, expected);
+    }
+    pfree(date_str);
+}
+
+/*
+ * Shadow check of a parse cache hit against sscanf() and ethiopian_to_jdn()
+ */
+static void
+verify_cached_ethiopian_date(const char *str, int len, DateADT day)
 {
-    text *input_text;
-    char *date_str;
-    int eth_year, eth_month, eth_day;
-    int jdn;
-    int greg_year, greg_month, greg_day;
-    DateADT date_val;
-    Timestamp result_timestamp;
-    
-    /* Handle NULL input */
-    if (PG_ARGISNULL(0))
-        PG_RETURN_NULL();
-    
-    /* Get the input text */
-    input_text = PG_GETARG_TEXT_P(0);
-    date_str = text_to_cstring(input_text);
-    
-    /* Parse the Ethiopian date string (format: YYYY-MM-DD) */
-    if (sscanf(date_str, "%d-%d-%d", &eth_year, &eth_month, &eth_day) != 3)
+    char *date_str = pnstrdup(str, len);
+    int ref_year, ref_month, ref_day;
+    int jdn = day + POSTGRES_EPOCH_JDATE;
+
+    if (sscanf(date_str, "%d-%d-%d", &ref_year, &ref_month, &ref_day) != 3 ||
+        jdn != ethiopian_to_jdn(ref_year, ref_month, ref_day))
     {
-        ereport(ERROR,
-                (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
-                 errmsg("invalid Ethiopian date format: %s (expected YYYY-MM-DD)", date_str)));
+        char result[32];
+        char expected[32];
+
+        snprintf(result, sizeof(result), "JDN %d (cached)", jdn);
+        snprintf(expected, sizeof(expected), "%d-%d-%d", ref_year, ref_month, ref_day);
+        report_verify_mismatch("from_ethiopian_date", quote_literal_cstr(date_str), result, expected);
     }
-    
+    pfree(date_str);
+}
+
+/*
+ * Raise the from_ethiopian_date() error for an invalid month or day
+ */
+static void
+check_ethiopian_date(int eth_year, int eth_month, int eth_day)
+{
     /* Validate month and day */
     if (eth_month < 1 || eth_month > 13)
     {
@@ -457,123 +712,2536 @@ from_ethiopian_date(PG_FUNCTION_ARGS)
                             eth_day, max_days, eth_year)));
         }
     }
-    
-    /* Convert Ethiopian date to Julian Day Number */
-    jdn = ethiopian_to_jdn(eth_year, eth_month, eth_day);
-    
-    /* Convert JDN to Gregorian date */
-    jdn_to_gregorian(jdn, &greg_year, &greg_month, &greg_day);
-    
-    /* Convert Gregorian date to PostgreSQL DATE */
-    date_val = gregorian_to_dateadt(greg_year, greg_month, greg_day);
-    
-    /* Convert DATE to TIMESTAMP (at midnight) */
-    result_timestamp = date_val * USECS_PER_DAY;
-    
-    PG_RETURN_TIMESTAMP(result_timestamp);
 }
 
 /*
- * PostgreSQL function: current_ethiopian_date()
+ * Parse and validate an Ethiopian date string of len bytes (no terminator
+ * needed), raising the from_ethiopian_date() errors for bad input
+ */
+static void
+parse_ethiopian_date(const char *str, int len, int *year, int *month, int *day)
+{
+    int eth_year, eth_month, eth_day;
+
+    if (!parse_fixed_ethiopian_date(str, len, &eth_year, &eth_month, &eth_day))
+    {
+        char *date_str = pnstrdup(str, len);
+
+        /* Scalar parser for irregular input (format: YYYY-MM-DD) */
+        if (sscanf(date_str, "%d-%d-%d", &eth_year, &eth_month, &eth_day) != 3)
+        {
+            ereport(ERROR,
+                    (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+                     errmsg("invalid Ethiopian date format: %s (expected YYYY-MM-DD)", date_str)));
+        }
+        pfree(date_str);
+    }
+    else if (unlikely(verify_sample_rate > 0) && verify_sample())
+        verify_fixed_ethiopian_date(str, len, eth_year, eth_month, eth_day);
+
+    check_ethiopian_date(eth_year, eth_month, eth_day);
+
+    *year = eth_year;
+    *month = eth_month;
+    *day = eth_day;
+}
+
+/*
+ * Parse cache for from_ethiopian_date()
  * 
- * Returns the current date in Ethiopian calendar as text.
- * This function is STABLE (not IMMUTABLE) because it depends on the current time.
+ * Imports repeat a few thousand distinct date strings over millions of rows.
+ * Each call site keeps a table in fn_extra from the raw input bytes (at most
+ * the 10 bytes of "YYYY-MM-DD") to the resulting day, so a repeated string
+ * costs a hash and a few memcmp calls: no parsing, validation or JDN
+ * conversion. The result is always midnight, so storing the day keeps an
+ * entry at 16 bytes. Sets are 4-way associative with the newest entry
+ * first; a full set drops its oldest entry. The table starts at 64 entries
+ * (1 kB) and doubles each time it has evicted half as many entries as it
+ * holds, up to 4096 entries (64 kB), so a call site that sees few distinct
+ * strings stays small. Only valid inputs are cached. Counters are per
+ * backend (ethiopian_calendar_parse_cache_stats()).
+ */
+#define DATE_CACHE_MIN_SET_BITS 4
+#define DATE_CACHE_MAX_SET_BITS 10
+#define DATE_CACHE_WAYS 4
+#define DATE_CACHE_KEYLEN 10
+
+typedef struct EthiopianDateCacheEntry
+{
+    char key[DATE_CACHE_KEYLEN];
+    uint8 len;                  /* 0 for an empty slot */
+    DateADT day;                /* the result is day * USECS_PER_DAY */
+} EthiopianDateCacheEntry;
+
+typedef struct EthiopianDateCache
+{
+    int set_bits;               /* the table has 1 << set_bits sets */
+    int evictions;              /* since the table was last grown */
+    EthiopianDateCacheEntry entries[FLEXIBLE_ARRAY_MEMBER];
+} EthiopianDateCache;
+
+#define DATE_CACHE_ENTRIES(bits) ((1 << (bits)) * DATE_CACHE_WAYS)
+
+static int64 date_cache_hits = 0;
+static int64 date_cache_misses = 0;
+static int64 date_cache_evictions = 0;
+
+/*
+ * Hash of an input of 1..DATE_CACHE_KEYLEN bytes; the top set_bits bits
+ * pick the set
  * 
- * Returns: TEXT (current Ethiopian calendar date as string in format YYYY-MM-DD)
+ * The two words are multiplied separately before they are combined, so
+ * strings that only swap digits between month and day land apart.
  */
-PG_FUNCTION_INFO_V1(current_ethiopian_date);
+static inline uint64
+date_cache_hash(const char *str, int len)
+{
+    uint64 head = 0;
+    uint64 tail = 0;
+
+    memcpy(&head, str, Min(len, 8));
+    if (len > 8)
+        memcpy(&tail, str + 8, len - 8);
+
+    return (head * UINT64CONST(0x9E3779B97F4A7C15)) ^
+           ((tail << 8 | (uint64) len) * UINT64CONST(0xC2B2AE3D27D4EB4F));
+}
+
+static inline EthiopianDateCacheEntry *
+date_cache_set(EthiopianDateCache *cache, const char *str, int len)
+{
+    uint64 set = date_cache_hash(str, len) >> (64 - cache->set_bits);
+
+    return &cache->entries[set * DATE_CACHE_WAYS];
+}
+
+static EthiopianDateCache *
+date_cache_create(MemoryContext mcxt, int set_bits)
+{
+    EthiopianDateCache *cache;
+
+    cache = (EthiopianDateCache *)
+        MemoryContextAllocZero(mcxt, offsetof(EthiopianDateCache, entries) +
+                               sizeof(EthiopianDateCacheEntry) * DATE_CACHE_ENTRIES(set_bits));
+    cache->set_bits = set_bits;
+    return cache;
+}
+
+/*
+ * Move every entry into a table with twice as many sets
+ * 
+ * A set's entries can only land in the two sets that share its hash
+ * prefix, so nothing is evicted. Reinserting oldest first keeps the newest
+ * entry at the front.
+ */
+static EthiopianDateCache *
+date_cache_grow(MemoryContext mcxt, EthiopianDateCache *old)
+{
+    EthiopianDateCache *cache = date_cache_create(mcxt, old->set_bits + 1);
+    int i;
+    int way;
+
+    for (i = 0; i < DATE_CACHE_ENTRIES(old->set_bits); i += DATE_CACHE_WAYS)
+    {
+        for (way = DATE_CACHE_WAYS - 1; way >= 0; way--)
+        {
+            EthiopianDateCacheEntry *entry = &old->entries[i + way];
+            EthiopianDateCacheEntry *set;
+
+            if (entry->len == 0)
+                continue;
+            set = date_cache_set(cache, entry->key, entry->len);
+            memmove(&set[1], &set[0], sizeof(EthiopianDateCacheEntry) * (DATE_CACHE_WAYS - 1));
+            set[0] = *entry;
+        }
+    }
+
+    pfree(old);
+    return cache;
+}
+
+/*
+ * PostgreSQL function: from_ethiopian_date(text)
+ * 
+ * Converts an Ethiopian calendar date string to a Gregorian timestamp.
+ * The input should be in format "YYYY-MM-DD" (Ethiopian calendar).
+ * Repeated strings are answered from the call site's parse cache.
+ * 
+ * Parameters:
+ *   ethiopian_date: Ethiopian calendar date as text (format: YYYY-MM-DD)
+ * 
+ * Returns: TIMESTAMP (Gregorian calendar timestamp at midnight)
+ */
+PG_FUNCTION_INFO_V1(from_ethiopian_date);
 
 Datum
-current_ethiopian_date(PG_FUNCTION_ARGS)
+from_ethiopian_date(PG_FUNCTION_ARGS)
 {
-    Timestamp current_ts;
-    DateADT date_val;
-    int greg_year, greg_month, greg_day;
+    text *input_text = PG_GETARG_TEXT_PP(0);
+    const char *str = VARDATA_ANY(input_text);
+    int len = VARSIZE_ANY_EXHDR(input_text);
+    EthiopianDateCache *cache = NULL;
+    EthiopianDateCacheEntry *set;
+    int eth_year, eth_month, eth_day;
     int jdn;
+    int way;
+
+    /* DirectFunctionCall has no flinfo, and longer input is never canonical */
+    if (fcinfo->flinfo != NULL && len > 0 && len <= DATE_CACHE_KEYLEN)
+    {
+        cache = (EthiopianDateCache *) fcinfo->flinfo->fn_extra;
+        if (cache == NULL)
+        {
+            cache = date_cache_create(fcinfo->flinfo->fn_mcxt, DATE_CACHE_MIN_SET_BITS);
+            fcinfo->flinfo->fn_extra = cache;
+        }
+
+        set = date_cache_set(cache, str, len);
+        for (way = 0; way < DATE_CACHE_WAYS; way++)
+        {
+            if (set[way].len == len && memcmp(set[way].key, str, len) == 0)
+            {
+                date_cache_hits++;
+                if (unlikely(verify_sample_rate > 0) && verify_sample())
+                    verify_cached_ethiopian_date(str, len, set[way].day);
+                PG_RETURN_TIMESTAMP((Timestamp) set[way].day * USECS_PER_DAY);
+            }
+        }
+        date_cache_misses++;
+    }
+
+    parse_ethiopian_date(str, len, &eth_year, &eth_month, &eth_day);
+
+    /* Convert Ethiopian date to Julian Day Number, then to a timestamp at midnight */
+    jdn = ethiopian_to_jdn(eth_year, eth_month, eth_day);
+
+    if (cache != NULL)
+    {
+        /* Grow instead of evicting once the table has turned over */
+        if (set[DATE_CACHE_WAYS - 1].len != 0 &&
+            ++cache->evictions >= DATE_CACHE_ENTRIES(cache->set_bits) / 2 &&
+            cache->set_bits < DATE_CACHE_MAX_SET_BITS)
+        {
+            cache = date_cache_grow(fcinfo->flinfo->fn_mcxt, cache);
+            fcinfo->flinfo->fn_extra = cache;
+            set = date_cache_set(cache, str, len);
+        }
+        if (set[DATE_CACHE_WAYS - 1].len != 0)
+            date_cache_evictions++;
+        memmove(&set[1], &set[0], sizeof(EthiopianDateCacheEntry) * (DATE_CACHE_WAYS - 1));
+        memcpy(set[0].key, str, len);
+        set[0].len = (uint8) len;
+        set[0].day = jdn - POSTGRES_EPOCH_JDATE;
+    }
+
+    PG_RETURN_TIMESTAMP((Timestamp) (jdn - POSTGRES_EPOCH_JDATE) * USECS_PER_DAY);
+}
+
+/*
+ * PostgreSQL function: ethiopian_calendar_parse_cache_stats()
+ * 
+ * Parse cache counters of this backend.
+ * 
+ * Returns: RECORD (hits BIGINT, misses BIGINT, evictions BIGINT,
+ *          hit_ratio DOUBLE PRECISION)
+ */
+PG_FUNCTION_INFO_V1(ethiopian_calendar_parse_cache_stats);
+
+Datum
+ethiopian_calendar_parse_cache_stats(PG_FUNCTION_ARGS)
+{
+    TupleDesc tupdesc;
+    Datum values[4];
+    bool nulls[4] = {false, false, false, false};
+    int64 lookups = date_cache_hits + date_cache_misses;
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("function returning record called in context that cannot accept type record")));
+
+    values[0] = Int64GetDatum(date_cache_hits);
+    values[1] = Int64GetDatum(date_cache_misses);
+    values[2] = Int64GetDatum(date_cache_evictions);
+    values[3] = Float8GetDatum(lookups > 0 ? (double) date_cache_hits / lookups : 0.0);
+
+    PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(BlessTupleDesc(tupdesc), values, nulls)));
+}
+
+/*
+ * PostgreSQL function: from_ethiopian_date(text[])
+ * 
+ * Batch form of from_ethiopian_date(text) for bulk ingest. All elements are
+ * parsed first (fixed-layout strings on the SWAR fast path), then converted
+ * in one pass with ethiopian_to_jdn_batch(). NULL elements stay NULL and the
+ * array keeps its dimensions; any invalid element raises the same error as
+ * the scalar function.
+ * 
+ * Returns: TIMESTAMP[] (Gregorian timestamps at midnight)
+ */
+PG_FUNCTION_INFO_V1(from_ethiopian_date_array);
+
+Datum
+from_ethiopian_date_array(PG_FUNCTION_ARGS)
+{
+    ArrayType *input = PG_GETARG_ARRAYTYPE_P(0);
+    Datum *elems;
+    bool *nulls;
+    int count;
+    int *years, *months, *days, *jdns;
+    int i;
+
+    deconstruct_array(input, TEXTOID, -1, false, 'i', &elems, &nulls, &count);
+
+    years = (int *) palloc(sizeof(int) * count);
+    months = (int *) palloc(sizeof(int) * count);
+    days = (int *) palloc(sizeof(int) * count);
+    jdns = (int *) palloc(sizeof(int) * count);
+
+    for (i = 0; i < count; i++)
+    {
+        text *date_text;
+
+        if (nulls[i])
+        {
+            /* Any valid date keeps the batch kernel branch-free */
+            years[i] = months[i] = days[i] = 1;
+            continue;
+        }
+
+        date_text = DatumGetTextPP(elems[i]);
+        parse_ethiopian_date(VARDATA_ANY(date_text), VARSIZE_ANY_EXHDR(date_text),
+                             &years[i], &months[i], &days[i]);
+    }
+
+    ethiopian_to_jdn_batch(years, months, days, count, jdns);
+
+    if (unlikely(verify_sample_rate > 0))
+    {
+        for (i = 0; i < count; i++)
+        {
+            if (!nulls[i] && verify_sample() &&
+                jdns[i] != ethiopian_to_jdn(years[i], months[i], days[i]))
+            {
+                char input[ETHIOPIAN_DATE_BUFLEN];
+                char result[16];
+                char expected[16];
+
+                format_ethiopian_date(input, years[i], months[i], days[i]);
+                snprintf(result, sizeof(result), "JDN %d", jdns[i]);
+                snprintf(expected, sizeof(expected), "JDN %d",
+                         ethiopian_to_jdn(years[i], months[i], days[i]));
+                report_verify_mismatch("ethiopian_to_jdn_batch", input, result, expected);
+            }
+        }
+    }
+
+    for (i = 0; i < count; i++)
+        elems[i] = TimestampGetDatum((Timestamp) (jdns[i] - POSTGRES_EPOCH_JDATE) * USECS_PER_DAY);
+
+    PG_RETURN_ARRAYTYPE_P(construct_md_array(elems, nulls, ARR_NDIM(input),
+                                             ARR_DIMS(input), ARR_LBOUND(input),
+                                             TIMESTAMPOID, sizeof(Timestamp),
+                                             FLOAT8PASSBYVAL, 'd'));
+}
+
+/*
+ * Scan between min_digits and max_digits decimal digits at *p
+ * 
+ * Returns: false if there are fewer than min_digits; otherwise advances *p
+ */
+static inline bool
+scan_digits(const char **p, const char *end, int min_digits, int max_digits, int *value)
+{
+    const char *start = *p;
+    const char *s = start;
+    int result = 0;
+
+    while (s < end && s - start < max_digits && (unsigned char) (*s - '0') <= 9)
+        result = result * 10 + (*s++ - '0');
+
+    if (s - start < min_digits)
+        return false;
+
+    *p = s;
+    *value = result;
+    return true;
+}
+
+pg_noinline static void
+report_bad_ethiopian_timestamp(const char *str, int len)
+{
+    ereport(ERROR,
+            (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+             errmsg("invalid Ethiopian timestamp format: %s (expected YYYY-MM-DD[ HH:MI[:SS[.US]]])",
+                    pnstrdup(str, len))));
+}
+
+/*
+ * PostgreSQL function: from_ethiopian_timestamp(text, boolean)
+ * 
+ * Converts an Ethiopian calendar date and wall-clock time to a Gregorian
+ * timestamp, e.g. '2016-13-05 14:30:15.123'. The time is optional, may follow
+ * a space or 'T', and takes seconds and up to microsecond fractions
+ * (further digits are rounded). The text is scanned once, straight from the
+ * varlena, and the result is built from the day number and microseconds.
+ * 
+ * With ethiopian_hours the time is on the Ethiopian clock, which counts from
+ * 06:00: 00:00 is 06:00 and 18:00 to 23:59 fall on the next Gregorian day.
+ * 
+ * Parameters:
+ *   ethiopian_timestamp: text (format: YYYY-MM-DD[ HH:MI[:SS[.US]]])
+ *   ethiopian_hours: BOOLEAN (time counted from 06:00, default false)
+ * 
+ * Returns: TIMESTAMP (Gregorian calendar timestamp)
+ */
+PG_FUNCTION_INFO_V1(from_ethiopian_timestamp);
+
+Datum
+from_ethiopian_timestamp(PG_FUNCTION_ARGS)
+{
+    text *input_text = PG_GETARG_TEXT_PP(0);
+    bool ethiopian_hours = PG_GETARG_BOOL(1);
+    const char *str = VARDATA_ANY(input_text);
+    int len = VARSIZE_ANY_EXHDR(input_text);
+    const char *p = str;
+    const char *end = str + len;
     int eth_year, eth_month, eth_day;
-    char result_str[12];
-    text *result;
-    
-    /* Get current timestamp */
-    current_ts = GetCurrentTimestamp();
-    
-    /* Extract date component from timestamp */
-    date_val = DatumGetDateADT(DirectFunctionCall1(timestamp_date, TimestampGetDatum(current_ts)));
-    
-    /* Convert PostgreSQL DATE to Gregorian components */
-    dateadt_to_gregorian(date_val, &greg_year, &greg_month, &greg_day);
-    
-    /* Convert Gregorian date to Julian Day Number */
-    jdn = gregorian_to_jdn(greg_year, greg_month, greg_day);
-    
-    /* Convert JDN to Ethiopian calendar */
-    jdn_to_ethiopian(jdn, &eth_year, &eth_month, &eth_day);
-    
-    /* Format as YYYY-MM-DD */
-    snprintf(result_str, sizeof(result_str), "%04d-%02d-%02d", eth_year, eth_month, eth_day);
-    
-    result = cstring_to_text(result_str);
-    PG_RETURN_TEXT_P(result);
+    int hour = 0, minute = 0, second = 0;
+    int64 usecs = 0;
+
+    while (p < end && isspace((unsigned char) *p))
+        p++;
+
+    /* Date: year (up to 5 digits, as to_ethiopian_date() writes them) - month - day */
+    if (!scan_digits(&p, end, 1, 5, &eth_year) ||
+        p >= end || *p++ != '-' ||
+        !scan_digits(&p, end, 1, 2, &eth_month) ||
+        p >= end || *p++ != '-' ||
+        !scan_digits(&p, end, 1, 2, &eth_day))
+        report_bad_ethiopian_timestamp(str, len);
+
+    /* Optional time: HH:MI[:SS[.fraction]] */
+    if (p < end && (*p == ' ' || *p == 'T') && p + 1 < end && !isspace((unsigned char) p[1]))
+    {
+        p++;
+        if (!scan_digits(&p, end, 1, 2, &hour) ||
+            p >= end || *p++ != ':' ||
+            !scan_digits(&p, end, 2, 2, &minute))
+            report_bad_ethiopian_timestamp(str, len);
+
+        if (p < end && *p == ':')
+        {
+            p++;
+            if (!scan_digits(&p, end, 2, 2, &second))
+                report_bad_ethiopian_timestamp(str, len);
+
+            if (p < end && *p == '.')
+            {
+                int scale = 100000;
+
+                p++;
+                if (p >= end || (unsigned char) (*p - '0') > 9)
+                    report_bad_ethiopian_timestamp(str, len);
+
+                while (p < end && (unsigned char) (*p - '0') <= 9)
+                {
+                    if (scale > 0)
+                        usecs += (*p - '0') * scale;
+                    else if (scale == 0 && *p >= '5')
+                        usecs++;        /* round on the 7th digit */
+                    scale = (scale > 0) ? scale / 10 : -1;
+                    p++;
+                }
+            }
+        }
+
+        if (hour > 23 || minute > 59 || second > 59)
+            ereport(ERROR,
+                    (errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
+                     errmsg("invalid Ethiopian time: %02d:%02d:%02d", hour, minute, second)));
+    }
+
+    while (p < end && isspace((unsigned char) *p))
+        p++;
+    if (p != end)
+        report_bad_ethiopian_timestamp(str, len);
+
+    check_ethiopian_date(eth_year, eth_month, eth_day);
+
+    usecs += hour * USECS_PER_HOUR + minute * USECS_PER_MINUTE + second * USECS_PER_SEC;
+    if (ethiopian_hours)
+        usecs += 6 * USECS_PER_HOUR;
+
+    PG_RETURN_TIMESTAMP((Timestamp) (ethiopian_to_jdn(eth_year, eth_month, eth_day) - POSTGRES_EPOCH_JDATE) *
+                        USECS_PER_DAY + usecs);
 }
 
 /*
- * PostgreSQL function: to_ethiopian_timestamp(timestamp)
+ * PostgreSQL function: _ethiopian_normalize_date(text)
  * 
- * Converts a Gregorian timestamp to an Ethiopian calendar TIMESTAMP.
- * The date is converted to Ethiopian calendar; the time-of-day remains the same.
- * This function returns TIMESTAMP (without time zone) for use in generated columns.
+ * Same result as to_ethiopian_date(from_ethiopian_date(x)), including its
+ * errors, without building the intermediate timestamp. Planned in by
+ * ethiopian_conversion_support().
  * 
- * Returns: TIMESTAMP (Ethiopian calendar date with original time preserved)
+ * Returns: TEXT (Ethiopian calendar date as string in format YYYY-MM-DD)
  */
-PG_FUNCTION_INFO_V1(to_ethiopian_timestamp);
+PG_FUNCTION_INFO_V1(ethiopian_normalize_date);
 
 Datum
-to_ethiopian_timestamp(PG_FUNCTION_ARGS)
+ethiopian_normalize_date(PG_FUNCTION_ARGS)
 {
-    Timestamp timestamp_val;
-    DateADT date_val;
+    text *input_text = PG_GETARG_TEXT_PP(0);
     int eth_year, eth_month, eth_day;
-    int greg_year, greg_month, greg_day;
     int jdn;
-    DateADT eth_date;
-    Timestamp result_timestamp;
-    TimeOffset time_offset;
-    
-    /* Handle NULL input */
-    if (PG_ARGISNULL(0))
-        PG_RETURN_NULL();
-    
-    /* Get the timestamp value */
-    timestamp_val = PG_GETARG_TIMESTAMP(0);
-    
-    /* Extract date and time components */
-    date_val = DatumGetDateADT(DirectFunctionCall1(timestamp_date, TimestampGetDatum(timestamp_val)));
-    time_offset = timestamp_val - (date_val * USECS_PER_DAY);
 
-    /* Convert PostgreSQL DATE to Gregorian components */
-    dateadt_to_gregorian(date_val, &greg_year, &greg_month, &greg_day);
+    parse_ethiopian_date(VARDATA_ANY(input_text), VARSIZE_ANY_EXHDR(input_text),
+                         &eth_year, &eth_month, &eth_day);
 
-    /* Convert Gregorian date to Julian Day Number */
-    jdn = gregorian_to_jdn(greg_year, greg_month, greg_day);
+    jdn = ethiopian_to_jdn(eth_year, eth_month, eth_day);
+    if (unlikely(jdn < ETHIOPIAN_EPOCH))
+        report_before_epoch();
 
-    /* Reject dates before Ethiopian calendar epoch (August 29, 8 CE = JDN 1724221) */
-    if (jdn < ETHIOPIAN_EPOCH)
-        ereport(ERROR,
-                (errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
-                 errmsg("date is before Ethiopian calendar epoch (August 29, 8 CE)")));
+    engine_jdn_to_ethiopian(jdn, &eth_year, &eth_month, &eth_day);
 
-    /* Convert JDN to Ethiopian calendar */
-    jdn_to_ethiopian(jdn, &eth_year, &eth_month, &eth_day);
+    PG_RETURN_TEXT_P(ethiopian_date_text(eth_year, eth_month, eth_day));
+}
 
-    /*
-     * Encode Ethiopian date components into a Gregorian-shaped DateADT so the
-     * timestamp displays Ethiopian year/month/day values.
-     */
-    eth_date = gregorian_to_dateadt(eth_year, eth_month, eth_day);
+/*
+ * PostgreSQL function: _ethiopian_day_trunc(timestamp)
+ * 
+ * Same result as from_ethiopian_date(to_ethiopian_date(ts)), including its
+ * errors, without formatting and parsing text. This is usually, but not
+ * always, the start of the Gregorian day: jdn_to_ethiopian() maps the last
+ * day of a four-year cycle onto the day before. Planned in by
+ * ethiopian_conversion_support().
+ * 
+ * Returns: TIMESTAMP (Gregorian calendar timestamp at midnight)
+ */
+PG_FUNCTION_INFO_V1(ethiopian_day_trunc);
+
+Datum
+ethiopian_day_trunc(PG_FUNCTION_ARGS)
+{
+    int jdn = timestamp_to_jdn(PG_GETARG_TIMESTAMP(0));
+    int eth_year, eth_month, eth_day;
+
+    if (unlikely(jdn < ETHIOPIAN_EPOCH))
+        report_before_epoch();
 
-    /* Combine Ethiopian date with original time */
-    result_timestamp = (eth_date * USECS_PER_DAY) + time_offset;
+    engine_jdn_to_ethiopian(jdn, &eth_year, &eth_month, &eth_day);
 
-    PG_RETURN_TIMESTAMP(result_timestamp);
+    PG_RETURN_TIMESTAMP((Timestamp) (ethiopian_to_jdn(eth_year, eth_month, eth_day) - POSTGRES_EPOCH_JDATE) *
+                        USECS_PER_DAY);
 }
 
+/*
+ * PostgreSQL function: ethiopian_conversion_support(internal)
+ * 
+ * Planner support function for the text conversions and their aliases
+ * (to_ethiopian_date, to_ethiopian_date_text, from_ethiopian_date and the
+ * pg_ethiopian_* names). SupportRequestSimplify folds inverse pairs:
+ *   to_ethiopian_date(from_ethiopian_date(x))  ->  _ethiopian_normalize_date(x)
+ *   from_ethiopian_date(to_ethiopian_date(ts)) ->  _ethiopian_day_trunc(ts)
+ * The inner call counts as a conversion when it has this same support
+ * function, so any alias combination is recognised; the direction follows
+ * from the argument type (timestamp: to, text: from). The pairs are not
+ * plain identities because from_ethiopian_date() accepts non-canonical
+ * input and rejects invalid dates, which the helpers preserve.
+ */
+PG_FUNCTION_INFO_V1(ethiopian_conversion_support);
+
+Datum
+ethiopian_conversion_support(PG_FUNCTION_ARGS)
+{
+    Node *rawreq = (Node *) PG_GETARG_POINTER(0);
+    Node *ret = NULL;
+
+    if (IsA(rawreq, SupportRequestSimplify))
+    {
+        SupportRequestSimplify *req = (SupportRequestSimplify *) rawreq;
+        FuncExpr *expr = req->fcall;
+        Node *arg = linitial(expr->args);
+        FuncExpr *inner;
+
+        /* A domain result (to_ethiopian_date_text) reaches us relabelled to text */
+        while (IsA(arg, RelabelType))
+            arg = (Node *) ((RelabelType *) arg)->arg;
+
+        if (!IsA(arg, FuncExpr))
+            PG_RETURN_POINTER(NULL);
+
+        inner = (FuncExpr *) arg;
+        if (list_length(inner->args) == 1 &&
+            get_func_support(inner->funcid) == get_func_support(expr->funcid))
+        {
+            Oid outer_type = exprType(linitial(expr->args));
+            Oid inner_type = exprType(linitial(inner->args));
+            const char *helper = NULL;
+            Oid argtypes[1];
+
+            if (outer_type != TIMESTAMPOID && inner_type == TIMESTAMPOID)
+            {
+                helper = "_ethiopian_day_trunc";
+                argtypes[0] = TIMESTAMPOID;
+            }
+            else if (outer_type == TIMESTAMPOID && inner_type != TIMESTAMPOID)
+            {
+                helper = "_ethiopian_normalize_date";
+                argtypes[0] = TEXTOID;
+            }
+
+            if (helper != NULL)
+            {
+                /* Helpers live in the same schema as the conversion functions */
+                char *nspname = get_namespace_name(get_func_namespace(expr->funcid));
+                Oid helper_oid;
+
+                helper_oid = LookupFuncName(list_make2(makeString(nspname), makeString(pstrdup(helper))),
+                                            1, argtypes, true);
+
+                if (OidIsValid(helper_oid))
+                    ret = (Node *) makeFuncExpr(helper_oid, expr->funcresulttype,
+                                                list_make1(linitial(inner->args)),
+                                                expr->funccollid, inner->inputcollid,
+                                                COERCE_EXPLICIT_CALL);
+            }
+        }
+    }
+
+    PG_RETURN_POINTER(ret);
+}
+
+/*
+ * PostgreSQL function: current_ethiopian_date()
+ * 
+ * Returns the current date in Ethiopian calendar as text.
+ * This function is STABLE (not IMMUTABLE) because it depends on the current time.
+ * 
+ * Returns: TEXT (current Ethiopian calendar date as string in format YYYY-MM-DD)
+ */
+PG_FUNCTION_INFO_V1(current_ethiopian_date);
+
+Datum
+current_ethiopian_date(PG_FUNCTION_ARGS)
+{
+    int jdn = timestamp_to_jdn(GetCurrentTimestamp());
+    int eth_year, eth_month, eth_day;
+
+    engine_jdn_to_ethiopian(jdn, &eth_year, &eth_month, &eth_day);
+
+    PG_RETURN_TEXT_P(ethiopian_date_text(eth_year, eth_month, eth_day));
+}
+
+/*
+ * PostgreSQL function: to_ethiopian_timestamp(timestamp)
+ * 
+ * Converts a Gregorian timestamp to an Ethiopian calendar TIMESTAMP.
+ * The date is converted to Ethiopian calendar; the time-of-day remains the same.
+ * This function returns TIMESTAMP (without time zone) for use in generated columns.
+ * 
+ * Returns: TIMESTAMP (Ethiopian calendar date with original time preserved)
+ */
+PG_FUNCTION_INFO_V1(to_ethiopian_timestamp);
+
+Datum
+to_ethiopian_timestamp(PG_FUNCTION_ARGS)
+{
+    Timestamp timestamp_val = PG_GETARG_TIMESTAMP(0);
+    int jdn = timestamp_to_jdn(timestamp_val);
+    int eth_year, eth_month, eth_day;
+
+    /* Reject dates before Ethiopian calendar epoch (August 29, 8 CE = JDN 1724221) */
+    if (unlikely(jdn < ETHIOPIAN_EPOCH))
+        report_before_epoch();
+
+    engine_jdn_to_ethiopian(jdn, &eth_year, &eth_month, &eth_day);
+
+    /*
+     * Encode Ethiopian date components into a Gregorian-shaped date so the
+     * timestamp displays Ethiopian year/month/day values, and keep the
+     * original time of day.
+     */
+    PG_RETURN_TIMESTAMP((Timestamp) gregorian_to_dateadt(eth_year, eth_month, eth_day) * USECS_PER_DAY +
+                        timestamp_time_of_day(timestamp_val));
+}
+
+
+/*
+ * Bucket granularities accepted by ethiopian_buckets()
+ */
+typedef enum EthiopianBucketUnit
+{
+    ETH_BUCKET_DAY,
+    ETH_BUCKET_WEEK,
+    ETH_BUCKET_MONTH,
+    ETH_BUCKET_QUARTER,
+    ETH_BUCKET_YEAR,
+    ETH_BUCKET_FISCAL_YEAR
+} EthiopianBucketUnit;
+
+/*
+ * Per-call state for ethiopian_buckets()
+ * 
+ * Buckets are walked in JDN space; next_jdn is the start of the next bucket
+ * to emit and end_jdn is the first day after the requested range.
+ */
+typedef struct EthiopianBucketState
+{
+    EthiopianBucketUnit unit;
+    int next_jdn;
+    int end_jdn;
+} EthiopianBucketState;
+
+/*
+ * Convert a Julian Day Number to a Gregorian timestamp at midnight
+ */
+static Timestamp
+jdn_to_timestamp(int jdn)
+{
+    return (Timestamp) (jdn - POSTGRES_EPOCH_JDATE) * USECS_PER_DAY;
+}
+
+/*
+ * Look up a granularity name without raising an error
+ * 
+ * Returns: true and sets *unit if the name is valid
+ */
+static bool
+lookup_bucket_unit(const char *name, EthiopianBucketUnit *unit)
+{
+    if (pg_strcasecmp(name, "day") == 0)
+        *unit = ETH_BUCKET_DAY;
+    else if (pg_strcasecmp(name, "week") == 0)
+        *unit = ETH_BUCKET_WEEK;
+    else if (pg_strcasecmp(name, "month") == 0)
+        *unit = ETH_BUCKET_MONTH;
+    else if (pg_strcasecmp(name, "quarter") == 0)
+        *unit = ETH_BUCKET_QUARTER;
+    else if (pg_strcasecmp(name, "year") == 0)
+        *unit = ETH_BUCKET_YEAR;
+    else if (pg_strcasecmp(name, "fiscal_year") == 0)
+        *unit = ETH_BUCKET_FISCAL_YEAR;
+    else
+        return false;
+
+    return true;
+}
+
+/*
+ * Parse a bucket granularity name (case-insensitive)
+ */
+static EthiopianBucketUnit
+parse_bucket_unit(const char *name)
+{
+    EthiopianBucketUnit unit;
+
+    if (!lookup_bucket_unit(name, &unit))
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("invalid Ethiopian bucket granularity: %s", name),
+                 errhint("Valid granularities are day, week, month, quarter, year and fiscal_year.")));
+
+    return unit;
+}
+
+/*
+ * Return the JDN of the first day of the bucket containing jdn
+ * 
+ * Bucket boundaries (Ethiopian calendar):
+ *   week:        7-day blocks counted from Meskerem 1; the last block of the
+ *                year is cut short at the end of Pagumē
+ *   quarter:     Meskerem-Hidar, Tahsas-Yekatit, Megabit-Ginbot,
+ *                Sene-Pagumē (Q4 includes Pagumē)
+ *   fiscal_year: Hamle 1 to Sene 30 of the following year
+ */
+static int
+bucket_floor(int jdn, EthiopianBucketUnit unit)
+{
+    int eth_year, eth_month, eth_day;
+    int year_start;
+
+    if (unit == ETH_BUCKET_DAY)
+        return jdn;
+
+    jdn_to_ethiopian(jdn, &eth_year, &eth_month, &eth_day);
+
+    switch (unit)
+    {
+        case ETH_BUCKET_WEEK:
+            year_start = ethiopian_to_jdn(eth_year, 1, 1);
+            return year_start + ((jdn - year_start) / 7) * 7;
+        case ETH_BUCKET_MONTH:
+            return ethiopian_to_jdn(eth_year, eth_month, 1);
+        case ETH_BUCKET_QUARTER:
+            return ethiopian_to_jdn(eth_year, Min((eth_month - 1) / 3, 3) * 3 + 1, 1);
+        case ETH_BUCKET_YEAR:
+            return ethiopian_to_jdn(eth_year, 1, 1);
+        case ETH_BUCKET_FISCAL_YEAR:
+            if (eth_month >= 11)
+                return ethiopian_to_jdn(eth_year, 11, 1);
+            return ethiopian_to_jdn(eth_year - 1, 11, 1);
+        default:
+            break;
+    }
+
+    return jdn;
+}
+
+/*
+ * Return the JDN of the first day of the bucket following the bucket that
+ * starts at start_jdn
+ */
+static int
+bucket_next(int start_jdn, EthiopianBucketUnit unit)
+{
+    int eth_year, eth_month, eth_day;
+    int next_year_start;
+
+    if (unit == ETH_BUCKET_DAY)
+        return start_jdn + 1;
+
+    jdn_to_ethiopian(start_jdn, &eth_year, &eth_month, &eth_day);
+
+    switch (unit)
+    {
+        case ETH_BUCKET_WEEK:
+            next_year_start = ethiopian_to_jdn(eth_year + 1, 1, 1);
+            return Min(start_jdn + 7, next_year_start);
+        case ETH_BUCKET_MONTH:
+            if (eth_month == 13)
+                return ethiopian_to_jdn(eth_year + 1, 1, 1);
+            return ethiopian_to_jdn(eth_year, eth_month + 1, 1);
+        case ETH_BUCKET_QUARTER:
+            if (eth_month >= 10)
+                return ethiopian_to_jdn(eth_year + 1, 1, 1);
+            return ethiopian_to_jdn(eth_year, eth_month + 3, 1);
+        case ETH_BUCKET_YEAR:
+            return ethiopian_to_jdn(eth_year + 1, 1, 1);
+        case ETH_BUCKET_FISCAL_YEAR:
+            return ethiopian_to_jdn(eth_year + 1, 11, 1);
+        default:
+            break;
+    }
+
+    return start_jdn + 1;
+}
+
+/*
+ * Format the label of the bucket starting at start_jdn
+ * 
+ * Labels: day "YYYY-MM-DD", week "YYYY-Www", month "YYYY-MM",
+ * quarter "YYYY-Qn", year "YYYY", fiscal_year "FYYYYY" (named after the
+ * Ethiopian year in which the fiscal year ends)
+ */
+static void
+bucket_label(int start_jdn, EthiopianBucketUnit unit, char *buf, size_t buflen)
+{
+    int eth_year, eth_month, eth_day;
+
+    jdn_to_ethiopian(start_jdn, &eth_year, &eth_month, &eth_day);
+
+    switch (unit)
+    {
+        case ETH_BUCKET_DAY:
+            snprintf(buf, buflen, "%04d-%02d-%02d", eth_year, eth_month, eth_day);
+            break;
+        case ETH_BUCKET_WEEK:
+            snprintf(buf, buflen, "%04d-W%02d", eth_year,
+                     (start_jdn - ethiopian_to_jdn(eth_year, 1, 1)) / 7 + 1);
+            break;
+        case ETH_BUCKET_MONTH:
+            snprintf(buf, buflen, "%04d-%02d", eth_year, eth_month);
+            break;
+        case ETH_BUCKET_QUARTER:
+            snprintf(buf, buflen, "%04d-Q%d", eth_year, (eth_month - 1) / 3 + 1);
+            break;
+        case ETH_BUCKET_YEAR:
+            snprintf(buf, buflen, "%04d", eth_year);
+            break;
+        case ETH_BUCKET_FISCAL_YEAR:
+            snprintf(buf, buflen, "FY%04d", eth_month >= 11 ? eth_year + 1 : eth_year);
+            break;
+    }
+}
+
+/*
+ * Average bucket length in days, used for planner row estimates
+ */
+static double
+bucket_average_days(EthiopianBucketUnit unit)
+{
+    switch (unit)
+    {
+        case ETH_BUCKET_DAY:
+            return 1.0;
+        case ETH_BUCKET_WEEK:
+            return 365.25 / 53.0;
+        case ETH_BUCKET_MONTH:
+            return 365.25 / 13.0;
+        case ETH_BUCKET_QUARTER:
+            return 365.25 / 4.0;
+        case ETH_BUCKET_YEAR:
+        case ETH_BUCKET_FISCAL_YEAR:
+            return 365.25;
+    }
+
+    return 1.0;
+}
+
+/*
+ * Whether bucket_range() accepts the range, without raising an error
+ */
+static bool
+bucket_range_is_valid(Timestamp range_start, Timestamp range_end)
+{
+    return !TIMESTAMP_NOT_FINITE(range_start) && !TIMESTAMP_NOT_FINITE(range_end) &&
+        timestamp_to_jdn(range_start) >= ETHIOPIAN_EPOCH;
+}
+
+/*
+ * Compute the JDN range [first bucket start, first day after range_end)
+ * covered by ethiopian_buckets(range_start, range_end, unit)
+ */
+static void
+bucket_range(Timestamp range_start, Timestamp range_end, EthiopianBucketUnit unit,
+             int *first_jdn, int *end_jdn)
+{
+    int start_jdn;
+
+    if (TIMESTAMP_NOT_FINITE(range_start) || TIMESTAMP_NOT_FINITE(range_end))
+        ereport(ERROR,
+                (errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
+                 errmsg("Ethiopian bucket range must be finite")));
+
+    start_jdn = timestamp_to_jdn(range_start);
+
+    /* Reject dates before Ethiopian calendar epoch (August 29, 8 CE = JDN 1724221) */
+    if (start_jdn < ETHIOPIAN_EPOCH)
+        report_before_epoch();
+
+    /* A bucket may start before the epoch only in year 1; clamp it */
+    *first_jdn = Max(bucket_floor(start_jdn, unit), ETHIOPIAN_EPOCH);
+
+    /* The range is half-open: a range_end at midnight excludes that day */
+    if (range_end <= range_start)
+        *end_jdn = *first_jdn;
+    else
+        *end_jdn = timestamp_to_jdn(range_end - 1) + 1;
+}
+
+/*
+ * PostgreSQL function: ethiopian_buckets(timestamp, timestamp, text)
+ * 
+ * Streams one row per Ethiopian calendar bucket (day, week, month, quarter,
+ * year or fiscal_year) overlapping the Gregorian range [range_start, range_end),
+ * including buckets with no data. Rows come out ordered by bucket_start, so
+ * they can be joined against pre-aggregated data without a second conversion.
+ * 
+ * Returns: SETOF (bucket_start TIMESTAMP, bucket_end TIMESTAMP, label TEXT)
+ *   bucket_start: Gregorian timestamp at midnight of the first day of the bucket
+ *   bucket_end:   Gregorian timestamp at midnight after the last day (exclusive)
+ *   label:        Ethiopian label of the bucket
+ */
+PG_FUNCTION_INFO_V1(ethiopian_buckets);
+
+Datum
+ethiopian_buckets(PG_FUNCTION_ARGS)
+{
+    FuncCallContext *funcctx;
+    EthiopianBucketState *state;
+    int bucket_start, bucket_end;
+    char label[32];
+    Datum values[3];
+    bool nulls[3] = {false, false, false};
+    HeapTuple tuple;
+
+    if (SRF_IS_FIRSTCALL())
+    {
+        MemoryContext oldcontext;
+        TupleDesc tupdesc;
+        char *unit_name;
+
+        funcctx = SRF_FIRSTCALL_INIT();
+        oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+        if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+            ereport(ERROR,
+                    (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                     errmsg("function returning record called in context that cannot accept type record")));
+        funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+        /* Resolve the granularity once for the whole call */
+        state = (EthiopianBucketState *) palloc(sizeof(EthiopianBucketState));
+        unit_name = text_to_cstring(PG_GETARG_TEXT_PP(2));
+        state->unit = parse_bucket_unit(unit_name);
+        bucket_range(PG_GETARG_TIMESTAMP(0), PG_GETARG_TIMESTAMP(1), state->unit,
+                     &state->next_jdn, &state->end_jdn);
+        funcctx->user_fctx = state;
+
+        MemoryContextSwitchTo(oldcontext);
+    }
+
+    funcctx = SRF_PERCALL_SETUP();
+    state = (EthiopianBucketState *) funcctx->user_fctx;
+
+    if (state->next_jdn >= state->end_jdn)
+        SRF_RETURN_DONE(funcctx);
+
+    bucket_start = state->next_jdn;
+    bucket_end = bucket_next(bucket_start, state->unit);
+    state->next_jdn = bucket_end;
+
+    bucket_label(bucket_start, state->unit, label, sizeof(label));
+
+    values[0] = TimestampGetDatum(jdn_to_timestamp(bucket_start));
+    values[1] = TimestampGetDatum(jdn_to_timestamp(bucket_end));
+    values[2] = CStringGetTextDatum(label);
+
+    tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+
+    SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
+/*
+ * PostgreSQL function: ethiopian_buckets_support(internal)
+ * 
+ * Planner support function for ethiopian_buckets(). When the range and the
+ * granularity are constants (or foldable to constants), the row estimate is
+ * the number of buckets instead of the fixed ROWS value. It never raises an
+ * error, so EXPLAIN and branches that never run plan even with bad arguments.
+ */
+PG_FUNCTION_INFO_V1(ethiopian_buckets_support);
+
+Datum
+ethiopian_buckets_support(PG_FUNCTION_ARGS)
+{
+    Node *rawreq = (Node *) PG_GETARG_POINTER(0);
+    Node *ret = NULL;
+
+    if (IsA(rawreq, SupportRequestRows))
+    {
+        SupportRequestRows *req = (SupportRequestRows *) rawreq;
+
+        if (is_funcclause(req->node))
+        {
+            List *args = ((FuncExpr *) req->node)->args;
+            Node *arg1, *arg2, *arg3;
+
+            arg1 = estimate_expression_value(req->root, linitial(args));
+            arg2 = estimate_expression_value(req->root, lsecond(args));
+            arg3 = estimate_expression_value(req->root, lthird(args));
+
+            if (IsA(arg1, Const) && !((Const *) arg1)->constisnull &&
+                IsA(arg2, Const) && !((Const *) arg2)->constisnull &&
+                IsA(arg3, Const) && !((Const *) arg3)->constisnull)
+            {
+                Timestamp range_start = DatumGetTimestamp(((Const *) arg1)->constvalue);
+                Timestamp range_end = DatumGetTimestamp(((Const *) arg2)->constvalue);
+                char *unit_name = TextDatumGetCString(((Const *) arg3)->constvalue);
+                EthiopianBucketUnit unit;
+                int first_jdn, end_jdn;
+
+                /* Invalid arguments get no estimate; the error is raised if the call runs */
+                if (lookup_bucket_unit(unit_name, &unit) &&
+                    bucket_range_is_valid(range_start, range_end))
+                {
+                    bucket_range(range_start, range_end, unit, &first_jdn, &end_jdn);
+
+                    req->rows = Max(ceil((end_jdn - first_jdn) / bucket_average_days(unit)), 1.0);
+                    ret = (Node *) req;
+                }
+            }
+        }
+    }
+
+    PG_RETURN_POINTER(ret);
+}
+
+/*
+ * Frequencies accepted in an ethiopian_recurrence() rule
+ */
+typedef enum EthiopianRecurFreq
+{
+    ETH_RECUR_DAILY,
+    ETH_RECUR_WEEKLY,
+    ETH_RECUR_MONTHLY,
+    ETH_RECUR_YEARLY
+} EthiopianRecurFreq;
+
+/*
+ * Parsed recurrence rule
+ * 
+ * month and day are 0 when the rule does not set them (taken from the start
+ * date); day is -1 for the last day of the month.
+ */
+typedef struct EthiopianRecurRule
+{
+    EthiopianRecurFreq freq;
+    int interval;
+    int month;
+    int day;
+} EthiopianRecurRule;
+
+/*
+ * Per-call-site state for ethiopian_recurrence(), kept in fn_extra
+ * 
+ * The last rule text and its parsed form survive across calls, so a rule
+ * that is the same for every row is parsed once. The iteration fields
+ * describe the set being returned while active is true.
+ */
+typedef struct EthiopianRecurState
+{
+    text *rule_text;            /* copy of the last parsed rule, or NULL */
+    EthiopianRecurRule rule;
+
+    bool active;
+    int64 index;                /* next occurrence number */
+    int64 remaining;            /* occurrences left, or -1 for no limit */
+    int start_jdn;
+    int start_year;
+    int start_month;
+    int start_day;
+    int64 time_of_day;          /* microseconds added to each occurrence */
+    Timestamp until;            /* DT_NOEND for no limit */
+} EthiopianRecurState;
+
+/*
+ * Report an invalid recurrence rule
+ */
+static void
+recur_rule_error(const char *rule, const char *detail)
+{
+    ereport(ERROR,
+            (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+             errmsg("invalid Ethiopian recurrence rule: \"%s\"", rule),
+             errdetail("%s", detail),
+             errhint("Use FREQ=DAILY|WEEKLY|MONTHLY|YEARLY with optional INTERVAL=n, MONTH=1-13 (YEARLY) and DAY=1-30 or -1, separated by ';'.")));
+}
+
+/*
+ * Parse an integer rule value within [min, max]
+ */
+static int
+recur_parse_int(const char *rule, const char *key, const char *value, int min, int max)
+{
+    char *end;
+    long result;
+
+    errno = 0;
+    result = strtol(value, &end, 10);
+    if (errno != 0 || end == value || *end != '\0' || result < min || result > max)
+        recur_rule_error(rule, psprintf("%s must be an integer between %d and %d.", key, min, max));
+
+    return (int) result;
+}
+
+/*
+ * Strip leading and trailing whitespace in place
+ */
+static char *
+recur_trim(char *str)
+{
+    char *end;
+
+    while (isspace((unsigned char) *str))
+        str++;
+    end = str + strlen(str);
+    while (end > str && isspace((unsigned char) end[-1]))
+        *--end = '\0';
+
+    return str;
+}
+
+/*
+ * Parse a rule such as "FREQ=MONTHLY;INTERVAL=2;DAY=30"
+ * 
+ * Keys and values are case-insensitive; whitespace around them is ignored.
+ */
+static void
+parse_recur_rule(const char *rule, EthiopianRecurRule *result)
+{
+    char *copy = pstrdup(rule);
+    char *item;
+    char *saveptr = NULL;
+    bool have_freq = false;
+
+    result->interval = 1;
+    result->month = 0;
+    result->day = 0;
+
+    for (item = strtok_r(copy, ";", &saveptr); item != NULL; item = strtok_r(NULL, ";", &saveptr))
+    {
+        char *eq = strchr(item, '=');
+        char *key, *value;
+
+        if (eq == NULL)
+            recur_rule_error(rule, psprintf("Expected KEY=VALUE, found \"%s\".", item));
+        *eq = '\0';
+
+        key = recur_trim(item);
+        value = recur_trim(eq + 1);
+
+        if (pg_strcasecmp(key, "freq") == 0)
+        {
+            if (pg_strcasecmp(value, "daily") == 0)
+                result->freq = ETH_RECUR_DAILY;
+            else if (pg_strcasecmp(value, "weekly") == 0)
+                result->freq = ETH_RECUR_WEEKLY;
+            else if (pg_strcasecmp(value, "monthly") == 0)
+                result->freq = ETH_RECUR_MONTHLY;
+            else if (pg_strcasecmp(value, "yearly") == 0)
+                result->freq = ETH_RECUR_YEARLY;
+            else
+                recur_rule_error(rule, psprintf("Unknown FREQ \"%s\".", value));
+            have_freq = true;
+        }
+        else if (pg_strcasecmp(key, "interval") == 0)
+            result->interval = recur_parse_int(rule, "INTERVAL", value, 1, 100000);
+        else if (pg_strcasecmp(key, "month") == 0)
+            result->month = recur_parse_int(rule, "MONTH", value, 1, 13);
+        else if (pg_strcasecmp(key, "day") == 0)
+        {
+            result->day = recur_parse_int(rule, "DAY", value, -1, 30);
+            if (result->day == 0)
+                recur_rule_error(rule, "DAY must be between 1 and 30, or -1 for the last day of the month.");
+        }
+        else
+            recur_rule_error(rule, psprintf("Unknown key \"%s\".", key));
+    }
+
+    if (!have_freq)
+        recur_rule_error(rule, "FREQ is required.");
+    if (result->month != 0 && result->freq != ETH_RECUR_YEARLY)
+        recur_rule_error(rule, "MONTH is only allowed with FREQ=YEARLY.");
+    if (result->day != 0 && (result->freq == ETH_RECUR_DAILY || result->freq == ETH_RECUR_WEEKLY))
+        recur_rule_error(rule, "DAY is only allowed with FREQ=MONTHLY or FREQ=YEARLY.");
+
+    pfree(copy);
+}
+
+/*
+ * JDN of an Ethiopian day in a month, with the day clamped to the month's
+ * length; day -1 is the last day. Pagumē's length is taken from
+ * ethiopian_to_jdn() itself (the day before next year's Meskerem 1), so an
+ * occurrence never spills into Meskerem and to_ethiopian_date() labels it
+ * with the same month.
+ */
+static int
+recur_clamped_jdn(int year, int month, int day)
+{
+    int month_days = 30;
+
+    if (month == 13)
+        month_days = ethiopian_to_jdn(year + 1, 1, 1) - ethiopian_to_jdn(year, 13, 1);
+
+    if (day < 0 || day > month_days)
+        day = month_days;
+
+    return ethiopian_to_jdn(year, month, day);
+}
+
+/*
+ * JDN of occurrence number index (0-based, before skipping dates earlier
+ * than the start), or -1 once past the timestamp range
+ */
+static int64
+recur_occurrence_jdn(const EthiopianRecurState *state, int64 index)
+{
+    const EthiopianRecurRule *rule = &state->rule;
+    int64 step = index * rule->interval;
+    int64 jdn;
+
+    switch (rule->freq)
+    {
+        case ETH_RECUR_DAILY:
+            jdn = state->start_jdn + step;
+            break;
+        case ETH_RECUR_WEEKLY:
+            jdn = state->start_jdn + step * 7;
+            break;
+        case ETH_RECUR_MONTHLY:
+            {
+                /* Months are counted continuously, 13 per year */
+                int64 month_index = (int64) (state->start_year - 1) * 13 + (state->start_month - 1) + step;
+
+                if (month_index / 13 + 1 > TIMESTAMP_END_JULIAN / 365)
+                    return -1;
+                jdn = recur_clamped_jdn((int) (month_index / 13) + 1, (int) (month_index % 13) + 1,
+                                        rule->day != 0 ? rule->day : state->start_day);
+                break;
+            }
+        case ETH_RECUR_YEARLY:
+        default:
+            if (state->start_year + step > TIMESTAMP_END_JULIAN / 365)
+                return -1;
+            jdn = recur_clamped_jdn(state->start_year + (int) step,
+                                    rule->month != 0 ? rule->month : state->start_month,
+                                    rule->day != 0 ? rule->day : state->start_day);
+            break;
+    }
+
+    return (jdn < TIMESTAMP_END_JULIAN) ? jdn : -1;
+}
+
+/*
+ * Expression-context shutdown callback: the set was abandoned (e.g. LIMIT or
+ * rescan), so the next call starts a new one
+ */
+static void
+recur_shutdown(Datum arg)
+{
+    EthiopianRecurState *state = (EthiopianRecurState *) DatumGetPointer(arg);
+
+    state->active = false;
+}
+
+/*
+ * Start a new set: parse the rule unless it matches the cached one, and
+ * set up the iteration from the arguments
+ */
+static void
+recur_begin(FunctionCallInfo fcinfo, EthiopianRecurState *state)
+{
+    text *rule_text = PG_GETARG_TEXT_PP(0);
+    Timestamp start = PG_GETARG_TIMESTAMP(1);
+    int start_jdn;
+
+    if (state->rule_text == NULL ||
+        VARSIZE_ANY_EXHDR(state->rule_text) != VARSIZE_ANY_EXHDR(rule_text) ||
+        memcmp(VARDATA_ANY(state->rule_text), VARDATA_ANY(rule_text), VARSIZE_ANY_EXHDR(rule_text)) != 0)
+    {
+        MemoryContext oldcontext;
+
+        parse_recur_rule(text_to_cstring(rule_text), &state->rule);
+
+        oldcontext = MemoryContextSwitchTo(fcinfo->flinfo->fn_mcxt);
+        if (state->rule_text != NULL)
+            pfree(state->rule_text);
+        state->rule_text = (text *) pg_detoast_datum_copy((struct varlena *) rule_text);
+        MemoryContextSwitchTo(oldcontext);
+    }
+
+    if (TIMESTAMP_NOT_FINITE(start))
+        ereport(ERROR,
+                (errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
+                 errmsg("Ethiopian recurrence start must be finite")));
+
+    if (PG_ARGISNULL(2) && PG_ARGISNULL(3))
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("ethiopian_recurrence() needs an until timestamp or a count")));
+
+    if (!PG_ARGISNULL(3) && PG_GETARG_INT32(3) < 0)
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("Ethiopian recurrence count must not be negative")));
+
+    start_jdn = timestamp_to_jdn(start);
+
+    /* Reject dates before Ethiopian calendar epoch (August 29, 8 CE = JDN 1724221) */
+    if (start_jdn < ETHIOPIAN_EPOCH)
+        report_before_epoch();
+
+    state->start_jdn = start_jdn;
+    jdn_to_ethiopian(start_jdn, &state->start_year, &state->start_month, &state->start_day);
+    state->time_of_day = start - jdn_to_timestamp(start_jdn);
+    state->until = PG_ARGISNULL(2) ? DT_NOEND : PG_GETARG_TIMESTAMP(2);
+    state->remaining = PG_ARGISNULL(3) ? -1 : PG_GETARG_INT32(3);
+    state->index = 0;
+    state->active = true;
+}
+
+/*
+ * PostgreSQL function: ethiopian_recurrence(text, timestamp, timestamp, integer)
+ * 
+ * Streams the Gregorian timestamps of a recurring Ethiopian calendar
+ * schedule, starting at start (inclusive) and stopping after count
+ * occurrences or after until (inclusive), whichever comes first. Each
+ * occurrence keeps the time of day of start.
+ * 
+ * Rule syntax (keys and values case-insensitive, separated by ';'):
+ *   FREQ=DAILY|WEEKLY|MONTHLY|YEARLY  required
+ *   INTERVAL=n                        every n-th period (default 1)
+ *   MONTH=1-13                        YEARLY only (default: start's month)
+ *   DAY=1-30 or -1                    MONTHLY/YEARLY (default: start's day);
+ *                                     clamped to the month's length, so 30
+ *                                     falls on the last day of Pagumē
+ * 
+ * Occurrences before start are skipped (e.g. DAY=17 when start is the 20th).
+ * 
+ * The rule is parsed once per call site while it stays the same, and rows
+ * are returned one per call (value-per-call), so a LIMIT stops the
+ * computation early.
+ */
+PG_FUNCTION_INFO_V1(ethiopian_recurrence);
+
+Datum
+ethiopian_recurrence(PG_FUNCTION_ARGS)
+{
+    ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+    EthiopianRecurState *state;
+
+    if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo) ||
+        (rsinfo->allowedModes & SFRM_ValuePerCall) == 0)
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("set-valued function called in context that cannot accept a set")));
+
+    state = (EthiopianRecurState *) fcinfo->flinfo->fn_extra;
+    if (state == NULL)
+    {
+        state = (EthiopianRecurState *) MemoryContextAllocZero(fcinfo->flinfo->fn_mcxt,
+                                                               sizeof(EthiopianRecurState));
+        fcinfo->flinfo->fn_extra = state;
+    }
+
+    if (!state->active)
+    {
+        /* NULL rule or start: empty set */
+        if (PG_ARGISNULL(0) || PG_ARGISNULL(1))
+        {
+            rsinfo->isDone = ExprEndResult;
+            PG_RETURN_NULL();
+        }
+
+        recur_begin(fcinfo, state);
+        RegisterExprContextCallback(rsinfo->econtext, recur_shutdown, PointerGetDatum(state));
+    }
+
+    if (state->remaining != 0)
+    {
+        int64 jdn;
+
+        do
+            jdn = recur_occurrence_jdn(state, state->index++);
+        while (jdn >= 0 && jdn < state->start_jdn);
+
+        if (jdn >= 0)
+        {
+            Timestamp result = jdn_to_timestamp((int) jdn) + state->time_of_day;
+
+            if (result <= state->until)
+            {
+                if (state->remaining > 0)
+                    state->remaining--;
+                rsinfo->isDone = ExprMultipleResult;
+                PG_RETURN_TIMESTAMP(result);
+            }
+        }
+    }
+
+    /* Done: the next call starts a new set */
+    state->active = false;
+    UnregisterExprContextCallback(rsinfo->econtext, recur_shutdown, PointerGetDatum(state));
+    rsinfo->isDone = ExprEndResult;
+    PG_RETURN_NULL();
+}
+
+/*
+ * Approximate days between occurrences of a rule
+ */
+static double
+recur_period_days(const EthiopianRecurRule *rule)
+{
+    switch (rule->freq)
+    {
+        case ETH_RECUR_DAILY:
+            return rule->interval;
+        case ETH_RECUR_WEEKLY:
+            return rule->interval * 7.0;
+        case ETH_RECUR_MONTHLY:
+            return rule->interval * 365.25 / 13.0;
+        case ETH_RECUR_YEARLY:
+            return rule->interval * 365.25;
+    }
+
+    return 1.0;
+}
+
+/*
+ * PostgreSQL function: ethiopian_recurrence_support(internal)
+ * 
+ * Planner support function for ethiopian_recurrence(). A constant count is
+ * used as the row estimate; with a constant rule, start and until the
+ * number of periods in the range is used (the smaller of the two if both
+ * are known).
+ */
+PG_FUNCTION_INFO_V1(ethiopian_recurrence_support);
+
+Datum
+ethiopian_recurrence_support(PG_FUNCTION_ARGS)
+{
+    Node *rawreq = (Node *) PG_GETARG_POINTER(0);
+    Node *ret = NULL;
+
+    if (IsA(rawreq, SupportRequestRows))
+    {
+        SupportRequestRows *req = (SupportRequestRows *) rawreq;
+
+        if (is_funcclause(req->node) && list_length(((FuncExpr *) req->node)->args) == 4)
+        {
+            List *args = ((FuncExpr *) req->node)->args;
+            Node *rule_arg, *start_arg, *until_arg, *count_arg;
+            double rows = -1;
+
+            rule_arg = estimate_expression_value(req->root, linitial(args));
+            start_arg = estimate_expression_value(req->root, lsecond(args));
+            until_arg = estimate_expression_value(req->root, lthird(args));
+            count_arg = estimate_expression_value(req->root, lfourth(args));
+
+            if (IsA(count_arg, Const) && !((Const *) count_arg)->constisnull)
+                rows = Max(DatumGetInt32(((Const *) count_arg)->constvalue), 0);
+
+            if (IsA(rule_arg, Const) && !((Const *) rule_arg)->constisnull &&
+                IsA(start_arg, Const) && !((Const *) start_arg)->constisnull &&
+                IsA(until_arg, Const) && !((Const *) until_arg)->constisnull)
+            {
+                Timestamp start = DatumGetTimestamp(((Const *) start_arg)->constvalue);
+                Timestamp until = DatumGetTimestamp(((Const *) until_arg)->constvalue);
+
+                if (!TIMESTAMP_NOT_FINITE(start) && !TIMESTAMP_NOT_FINITE(until))
+                {
+                    EthiopianRecurRule rule;
+                    double periods;
+
+                    parse_recur_rule(TextDatumGetCString(((Const *) rule_arg)->constvalue), &rule);
+                    periods = floor((double) (until - start) / USECS_PER_DAY / recur_period_days(&rule)) + 1;
+                    periods = Max(periods, 0);
+                    rows = (rows < 0) ? periods : Min(rows, periods);
+                }
+            }
+
+            if (rows >= 0)
+            {
+                req->rows = Max(rows, 1.0);
+                ret = (Node *) req;
+            }
+        }
+    }
+
+    PG_RETURN_POINTER(ret);
+}
+
+/*
+ * Fields accepted by ethiopian_date_part()
+ */
+typedef enum EthiopianField
+{
+    ETH_FIELD_YEAR,
+    ETH_FIELD_MONTH,
+    ETH_FIELD_DAY,
+    ETH_FIELD_DOY,
+    ETH_FIELD_DOW,
+    ETH_FIELD_WEEK,
+    ETH_FIELD_QUARTER,
+    ETH_FIELD_FISCAL_YEAR,
+    ETH_FIELD_LEAP
+} EthiopianField;
+
+/*
+ * Field names and the pass-by-value extractor each one maps to.
+ * The extractor return type is int4, except for leap which is boolean.
+ */
+typedef struct EthiopianFieldInfo
+{
+    const char *name;
+    EthiopianField field;
+    const char *extractor;
+    bool returns_bool;
+} EthiopianFieldInfo;
+
+static const EthiopianFieldInfo ethiopian_fields[] = {
+    {"year", ETH_FIELD_YEAR, "ethiopian_year", false},
+    {"month", ETH_FIELD_MONTH, "ethiopian_month", false},
+    {"day", ETH_FIELD_DAY, "ethiopian_day", false},
+    {"doy", ETH_FIELD_DOY, "ethiopian_day_of_year", false},
+    {"dow", ETH_FIELD_DOW, "ethiopian_day_of_week", false},
+    {"week", ETH_FIELD_WEEK, "ethiopian_week", false},
+    {"quarter", ETH_FIELD_QUARTER, "ethiopian_quarter", false},
+    {"fiscal_year", ETH_FIELD_FISCAL_YEAR, "ethiopian_fiscal_year", false},
+    {"leap", ETH_FIELD_LEAP, "is_ethiopian_leap_year", true}
+};
+
+/* Before PostgreSQL 14, fmgroids.h named the built-in casts after their C symbols */
+#if PG_VERSION_NUM < 140000
+#define F_FLOAT8_INT4 F_I4TOD
+#define F_INT4_BOOL F_BOOL_INT4
+#endif
+
+/*
+ * Per-call-site cache of the last field name seen by ethiopian_date_part()
+ */
+typedef struct EthiopianFieldCache
+{
+    int len;
+    char name[NAMEDATALEN];
+    const EthiopianFieldInfo *info;
+} EthiopianFieldCache;
+
+/*
+ * Look up a field by name (case-insensitive), or return NULL if unknown
+ */
+static const EthiopianFieldInfo *
+lookup_ethiopian_field(const char *name, int len)
+{
+    char lowered[NAMEDATALEN];
+    int i;
+
+    if (len <= 0 || len >= NAMEDATALEN)
+        return NULL;
+
+    memcpy(lowered, name, len);
+    lowered[len] = '\0';
+
+    for (i = 0; i < lengthof(ethiopian_fields); i++)
+    {
+        if (pg_strcasecmp(lowered, ethiopian_fields[i].name) == 0)
+            return &ethiopian_fields[i];
+    }
+
+    return NULL;
+}
+
+/*
+ * Compute one Ethiopian date field for a Julian Day Number
+ * 
+ * Field definitions:
+ *   doy:         day of the Ethiopian year (1-366)
+ *   dow:         day of the week, 0 = Sunday (Ehud) ... 6 = Saturday, as in date_part()
+ *   week:        7-day block of the year counted from Meskerem 1 (1-53)
+ *   quarter:     1-4, with Pagumē in quarter 4
+ *   fiscal_year: Ethiopian fiscal year (Hamle 1 to Sene 30), named after
+ *                the year in which it ends
+ *   leap:        1 in Ethiopian leap years (year % 4 == 3), else 0
+ */
+static int
+ethiopian_field_value(int jdn, EthiopianField field)
+{
+    int eth_year, eth_month, eth_day;
+    int doy;
+
+    engine_jdn_to_ethiopian(jdn, &eth_year, &eth_month, &eth_day);
+    doy = (eth_month - 1) * 30 + eth_day;
+
+    switch (field)
+    {
+        case ETH_FIELD_YEAR:
+            return eth_year;
+        case ETH_FIELD_MONTH:
+            return eth_month;
+        case ETH_FIELD_DAY:
+            return eth_day;
+        case ETH_FIELD_DOY:
+            return doy;
+        case ETH_FIELD_DOW:
+            /* JDN 0 was a Monday */
+            return (jdn + 1) % 7;
+        case ETH_FIELD_WEEK:
+            return (doy - 1) / 7 + 1;
+        case ETH_FIELD_QUARTER:
+            return Min((eth_month - 1) / 3, 3) + 1;
+        case ETH_FIELD_FISCAL_YEAR:
+            return eth_month >= 11 ? eth_year + 1 : eth_year;
+        case ETH_FIELD_LEAP:
+            return eth_year % 4 == 3;
+    }
+
+    return 0;
+}
+
+/*
+ * Compute one Ethiopian date field for a Gregorian timestamp
+ */
+static int
+ethiopian_extract(Timestamp timestamp_val, EthiopianField field)
+{
+    int jdn = timestamp_to_jdn(timestamp_val);
+
+    /* Reject dates before Ethiopian calendar epoch (August 29, 8 CE = JDN 1724221) */
+    if (unlikely(jdn < ETHIOPIAN_EPOCH))
+        report_before_epoch();
+
+    return ethiopian_field_value(jdn, field);
+}
+
+/*
+ * PostgreSQL functions: ethiopian_year(timestamp), ethiopian_month(timestamp),
+ * ethiopian_day(timestamp), ethiopian_day_of_year(timestamp),
+ * ethiopian_day_of_week(timestamp), ethiopian_week(timestamp),
+ * ethiopian_quarter(timestamp), ethiopian_fiscal_year(timestamp)
+ * 
+ * Extract a single Ethiopian calendar field from a Gregorian timestamp.
+ * 
+ * Returns: INTEGER
+ */
+PG_FUNCTION_INFO_V1(ethiopian_year);
+
+Datum
+ethiopian_year(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_INT32(ethiopian_extract(PG_GETARG_TIMESTAMP(0), ETH_FIELD_YEAR));
+}
+
+PG_FUNCTION_INFO_V1(ethiopian_month);
+
+Datum
+ethiopian_month(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_INT32(ethiopian_extract(PG_GETARG_TIMESTAMP(0), ETH_FIELD_MONTH));
+}
+
+PG_FUNCTION_INFO_V1(ethiopian_day);
+
+Datum
+ethiopian_day(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_INT32(ethiopian_extract(PG_GETARG_TIMESTAMP(0), ETH_FIELD_DAY));
+}
+
+PG_FUNCTION_INFO_V1(ethiopian_day_of_year);
+
+Datum
+ethiopian_day_of_year(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_INT32(ethiopian_extract(PG_GETARG_TIMESTAMP(0), ETH_FIELD_DOY));
+}
+
+PG_FUNCTION_INFO_V1(ethiopian_day_of_week);
+
+Datum
+ethiopian_day_of_week(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_INT32(ethiopian_extract(PG_GETARG_TIMESTAMP(0), ETH_FIELD_DOW));
+}
+
+PG_FUNCTION_INFO_V1(ethiopian_week);
+
+Datum
+ethiopian_week(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_INT32(ethiopian_extract(PG_GETARG_TIMESTAMP(0), ETH_FIELD_WEEK));
+}
+
+PG_FUNCTION_INFO_V1(ethiopian_quarter);
+
+Datum
+ethiopian_quarter(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_INT32(ethiopian_extract(PG_GETARG_TIMESTAMP(0), ETH_FIELD_QUARTER));
+}
+
+PG_FUNCTION_INFO_V1(ethiopian_fiscal_year);
+
+Datum
+ethiopian_fiscal_year(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_INT32(ethiopian_extract(PG_GETARG_TIMESTAMP(0), ETH_FIELD_FISCAL_YEAR));
+}
+
+/*
+ * PostgreSQL function: is_ethiopian_leap_year(timestamp)
+ * 
+ * Returns: BOOLEAN (true if the timestamp falls in an Ethiopian leap year)
+ */
+PG_FUNCTION_INFO_V1(is_ethiopian_leap_year);
+
+Datum
+is_ethiopian_leap_year(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_BOOL(ethiopian_extract(PG_GETARG_TIMESTAMP(0), ETH_FIELD_LEAP) != 0);
+}
+
+/*
+ * PostgreSQL function: ethiopian_date_part(text, timestamp)
+ * 
+ * Generic field extraction, analogous to date_part(). Fields: year, month,
+ * day, doy, dow, week, quarter, fiscal_year, leap.
+ * 
+ * With a constant field the planner replaces this call by the matching
+ * extractor (see ethiopian_date_part_support), so this path only runs for
+ * non-constant fields. The resolved field is cached in fn_extra and reused
+ * while consecutive rows pass the same field name.
+ * 
+ * Returns: DOUBLE PRECISION
+ */
+PG_FUNCTION_INFO_V1(ethiopian_date_part);
+
+Datum
+ethiopian_date_part(PG_FUNCTION_ARGS)
+{
+    text *field_text = PG_GETARG_TEXT_PP(0);
+    const char *field_name = VARDATA_ANY(field_text);
+    int field_len = VARSIZE_ANY_EXHDR(field_text);
+    EthiopianFieldCache *cache = (EthiopianFieldCache *) fcinfo->flinfo->fn_extra;
+
+    if (cache == NULL)
+    {
+        cache = (EthiopianFieldCache *) MemoryContextAllocZero(fcinfo->flinfo->fn_mcxt,
+                                                               sizeof(EthiopianFieldCache));
+        fcinfo->flinfo->fn_extra = cache;
+    }
+
+    if (cache->info == NULL || cache->len != field_len ||
+        memcmp(cache->name, field_name, field_len) != 0)
+    {
+        const EthiopianFieldInfo *info = lookup_ethiopian_field(field_name, field_len);
+
+        if (info == NULL)
+            ereport(ERROR,
+                    (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                     errmsg("unsupported Ethiopian date field: %s", text_to_cstring(field_text)),
+                     errhint("Valid fields are year, month, day, doy, dow, week, quarter, fiscal_year and leap.")));
+
+        /* lookup_ethiopian_field() only accepts names shorter than NAMEDATALEN */
+        memcpy(cache->name, field_name, field_len);
+        cache->len = field_len;
+        cache->info = info;
+    }
+
+    PG_RETURN_FLOAT8((float8) ethiopian_extract(PG_GETARG_TIMESTAMP(1), cache->info->field));
+}
+
+/*
+ * PostgreSQL function: ethiopian_date_part_support(internal)
+ * 
+ * Planner support function for ethiopian_date_part(). When the field is a
+ * constant, SupportRequestSimplify rewrites
+ *   ethiopian_date_part('month', ts)
+ * into
+ *   float8(ethiopian_month(ts))
+ * so there is no per-row field dispatch. Unknown fields are left alone and
+ * reported at execution time.
+ */
+PG_FUNCTION_INFO_V1(ethiopian_date_part_support);
+
+Datum
+ethiopian_date_part_support(PG_FUNCTION_ARGS)
+{
+    Node *rawreq = (Node *) PG_GETARG_POINTER(0);
+    Node *ret = NULL;
+
+    if (IsA(rawreq, SupportRequestSimplify))
+    {
+        SupportRequestSimplify *req = (SupportRequestSimplify *) rawreq;
+        FuncExpr *expr = req->fcall;
+        Node *field_arg = linitial(expr->args);
+
+        if (IsA(field_arg, Const) && !((Const *) field_arg)->constisnull)
+        {
+            text *field_text = DatumGetTextPP(((Const *) field_arg)->constvalue);
+            const EthiopianFieldInfo *info;
+
+            info = lookup_ethiopian_field(VARDATA_ANY(field_text), VARSIZE_ANY_EXHDR(field_text));
+
+            if (info != NULL)
+            {
+                /* Extractors live in the same schema as ethiopian_date_part() */
+                char *nspname = get_namespace_name(get_func_namespace(expr->funcid));
+                Oid argtypes[1] = {TIMESTAMPOID};
+                Oid extractor;
+
+                extractor = LookupFuncName(list_make2(makeString(nspname),
+                                                      makeString(pstrdup(info->extractor))),
+                                           1, argtypes, true);
+
+                if (OidIsValid(extractor))
+                {
+                    Node *result;
+
+                    result = (Node *) makeFuncExpr(extractor,
+                                                   info->returns_bool ? BOOLOID : INT4OID,
+                                                   list_make1(lsecond(expr->args)),
+                                                   InvalidOid, InvalidOid,
+                                                   COERCE_EXPLICIT_CALL);
+                    if (info->returns_bool)
+                        result = (Node *) makeFuncExpr(F_INT4_BOOL, INT4OID,
+                                                       list_make1(result),
+                                                       InvalidOid, InvalidOid,
+                                                       COERCE_EXPLICIT_CAST);
+                    result = (Node *) makeFuncExpr(F_FLOAT8_INT4, FLOAT8OID,
+                                                   list_make1(result),
+                                                   InvalidOid, InvalidOid,
+                                                   COERCE_EXPLICIT_CAST);
+                    ret = result;
+                }
+            }
+        }
+    }
+
+    PG_RETURN_POINTER(ret);
+}
+
+/*
+ * Type ethiopian_date_set: a compact set of days for per-entity calendars
+ * (working days, closures)
+ * 
+ * Days are stored as DateADT (days since 2000-01-01) between first and last,
+ * in whichever layout is smaller:
+ *   bitmap:  one bit per day from first to last; membership is O(1)
+ *   offsets: sorted (day - first), as uint16 while the span fits in 16 bits
+ *            and uint32 otherwise; membership is a binary search
+ * Working-day calendars are dense and become bitmaps (46 bytes a year);
+ * closure calendars are sparse and become offsets (2 bytes a day). Both are
+ * far below the TOAST threshold for any realistic calendar, unlike date[].
+ * 
+ * The text form lists Gregorian ISO dates, runs of consecutive days written
+ * as first..last, so it round-trips exactly whatever the DateStyle:
+ *   {2024-01-01..2024-01-05,2024-01-08}
+ * Sets are built from Ethiopian dates with ethiopian_date_set(from, to, dow).
+ */
+#define DATE_SET_BITMAP 0
+#define DATE_SET_OFFSETS16 1
+#define DATE_SET_OFFSETS32 2
+
+typedef struct EthiopianDateSet
+{
+    int32 vl_len_;              /* varlena header (do not touch directly!) */
+    int32 format;               /* DATE_SET_* */
+    int32 count;                /* number of days */
+    DateADT first;              /* smallest day, 0 when empty */
+    DateADT last;               /* largest day, 0 when empty */
+    char data[FLEXIBLE_ARRAY_MEMBER];
+} EthiopianDateSet;
+
+#define DATE_SET_HDRSZ offsetof(EthiopianDateSet, data)
+
+/*
+ * Every set stays within 0001-01-01 .. 9999-12-31 (JDN 1721426 .. 5373484),
+ * the years the four-digit text form can write, which also bounds its size
+ */
+#define DATE_SET_MIN_DAY (1721426 - POSTGRES_EPOCH_JDATE)
+#define DATE_SET_MAX_DAY (5373484 - POSTGRES_EPOCH_JDATE)
+#define DATE_SET_MAX_DAYS 4000000
+#define PG_GETARG_DATE_SET_P(n) ((EthiopianDateSet *) PG_DETOAST_DATUM(PG_GETARG_DATUM(n)))
+
+static int
+date_set_compare_days(const void *a, const void *b)
+{
+    DateADT x = *(const DateADT *) a;
+    DateADT y = *(const DateADT *) b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+ * Sort days and drop duplicates in place
+ * 
+ * Returns: the new count
+ */
+static int
+date_set_sort_days(DateADT *days, int count)
+{
+    int unique = 0;
+    int i;
+
+    if (count == 0)
+        return 0;
+
+    qsort(days, count, sizeof(DateADT), date_set_compare_days);
+
+    for (i = 1; i < count; i++)
+    {
+        if (days[i] != days[unique])
+            days[++unique] = days[i];
+    }
+    return unique + 1;
+}
+
+pg_noinline static void
+report_date_set_too_large(void)
+{
+    ereport(ERROR,
+            (errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+             errmsg("ethiopian_date_set cannot hold more than %d days", DATE_SET_MAX_DAYS)));
+}
+
+/*
+ * Build a set from days that are sorted and unique
+ * 
+ * Every constructor ends here, so this is where the date range and size
+ * limits are enforced.
+ */
+static EthiopianDateSet *
+date_set_build(const DateADT *days, int count)
+{
+    EthiopianDateSet *set;
+    int64 span;
+    Size bitmap_size, offsets_size;
+    int format;
+    int i;
+
+    if (count > DATE_SET_MAX_DAYS)
+        report_date_set_too_large();
+
+    if (count > 0 && (days[0] < DATE_SET_MIN_DAY || days[count - 1] > DATE_SET_MAX_DAY))
+        ereport(ERROR,
+                (errcode(ERRCODE_DATETIME_VALUE_OUT_OF_RANGE),
+                 errmsg("date out of range for ethiopian_date_set"),
+                 errhint("Dates must be between 0001-01-01 and 9999-12-31.")));
+
+    if (count == 0)
+    {
+        set = (EthiopianDateSet *) palloc0(DATE_SET_HDRSZ);
+        SET_VARSIZE(set, DATE_SET_HDRSZ);
+        set->format = DATE_SET_OFFSETS16;
+        return set;
+    }
+
+    span = (int64) days[count - 1] - days[0] + 1;
+    bitmap_size = (Size) ((span + 7) / 8);
+    offsets_size = (Size) count * (span <= 65536 ? sizeof(uint16) : sizeof(uint32));
+
+    if (bitmap_size <= offsets_size)
+        format = DATE_SET_BITMAP;
+    else
+        format = (span <= 65536) ? DATE_SET_OFFSETS16 : DATE_SET_OFFSETS32;
+
+    set = (EthiopianDateSet *) palloc0(DATE_SET_HDRSZ + Min(bitmap_size, offsets_size));
+    SET_VARSIZE(set, DATE_SET_HDRSZ + Min(bitmap_size, offsets_size));
+    set->format = format;
+    set->count = count;
+    set->first = days[0];
+    set->last = days[count - 1];
+
+    for (i = 0; i < count; i++)
+    {
+        uint32 offset = (uint32) (days[i] - set->first);
+
+        if (format == DATE_SET_BITMAP)
+            set->data[offset >> 3] |= (char) (1 << (offset & 7));
+        else if (format == DATE_SET_OFFSETS16)
+            ((uint16 *) set->data)[i] = (uint16) offset;
+        else
+            ((uint32 *) set->data)[i] = offset;
+    }
+
+    return set;
+}
+
+/*
+ * Decode a set into a palloc'd array of its days, in order
+ */
+static DateADT *
+date_set_days(const EthiopianDateSet *set)
+{
+    DateADT *days = (DateADT *) palloc(sizeof(DateADT) * Max(set->count, 1));
+    int i;
+
+    if (set->format == DATE_SET_BITMAP)
+    {
+        uint32 span = (uint32) (set->last - set->first) + 1;
+        uint32 offset;
+        int n = 0;
+
+        for (offset = 0; offset < span; offset++)
+        {
+            if (set->data[offset >> 3] & (1 << (offset & 7)))
+                days[n++] = set->first + (DateADT) offset;
+        }
+    }
+    else
+    {
+        for (i = 0; i < set->count; i++)
+            days[i] = set->first + (DateADT) ((set->format == DATE_SET_OFFSETS16)
+                                              ? ((const uint16 *) set->data)[i]
+                                              : ((const uint32 *) set->data)[i]);
+    }
+
+    return days;
+}
+
+static bool
+date_set_contains(const EthiopianDateSet *set, DateADT day)
+{
+    uint32 offset;
+    int low, high;
+
+    if (set->count == 0 || day < set->first || day > set->last)
+        return false;
+
+    offset = (uint32) (day - set->first);
+
+    if (set->format == DATE_SET_BITMAP)
+        return (set->data[offset >> 3] & (1 << (offset & 7))) != 0;
+
+    low = 0;
+    high = set->count - 1;
+    while (low <= high)
+    {
+        int middle = low + (high - low) / 2;
+        uint32 value = (set->format == DATE_SET_OFFSETS16)
+            ? ((const uint16 *) set->data)[middle]
+            : ((const uint32 *) set->data)[middle];
+
+        if (value == offset)
+            return true;
+        if (value < offset)
+            low = middle + 1;
+        else
+            high = middle - 1;
+    }
+    return false;
+}
+
+/*
+ * Append count days to a growing array, raising an error past the limit
+ */
+static DateADT *
+date_set_append_range(DateADT *days, int *count, int *capacity, DateADT from, DateADT to)
+{
+    if ((int64) to - from + 1 > DATE_SET_MAX_DAYS - (int64) *count)
+        report_date_set_too_large();
+
+    while (*count + (to - from + 1) > *capacity)
+    {
+        *capacity *= 2;
+        days = (DateADT *) repalloc(days, sizeof(DateADT) * *capacity);
+    }
+
+    while (from <= to)
+        days[(*count)++] = from++;
+
+    return days;
+}
+
+pg_noinline static void
+report_bad_date_set(const char *str)
+{
+    ereport(ERROR,
+            (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+             errmsg("invalid input syntax for type ethiopian_date_set: \"%s\"", str),
+             errhint("Use Gregorian ISO dates and ranges, e.g. {2024-01-01..2024-01-05,2024-01-08}.")));
+}
+
+/*
+ * Scan a Gregorian ISO date (YYYY-MM-DD, years 1-9999) at *p
+ */
+static bool
+scan_iso_date(const char **p, const char *end, DateADT *result)
+{
+    int year, month, day;
+    int check_year, check_month, check_day;
+    int jdn;
+
+    if (!scan_digits(p, end, 4, 4, &year) ||
+        *p >= end || *(*p)++ != '-' ||
+        !scan_digits(p, end, 2, 2, &month) ||
+        *p >= end || *(*p)++ != '-' ||
+        !scan_digits(p, end, 2, 2, &day))
+        return false;
+
+    if (year < 1 || month < 1 || month > 12 || day < 1 || day > 31)
+        return false;
+
+    /* Rejects days past the end of the month */
+    jdn = gregorian_to_jdn(year, month, day);
+    jdn_to_gregorian(jdn, &check_year, &check_month, &check_day);
+    if (check_month != month || check_day != day)
+        return false;
+
+    *result = jdn - POSTGRES_EPOCH_JDATE;
+    return true;
+}
+
+static void
+append_iso_date(StringInfo buf, DateADT day)
+{
+    int year, month, day_of_month;
+
+    jdn_to_gregorian(day + POSTGRES_EPOCH_JDATE, &year, &month, &day_of_month);
+    appendStringInfo(buf, "%04d-%02d-%02d", year, month, day_of_month);
+}
+
+/*
+ * PostgreSQL function: ethiopian_date_set_in(cstring)
+ * 
+ * Input function for ethiopian_date_set: {day[..day], ...} with Gregorian
+ * ISO dates, in any order, overlaps allowed.
+ */
+PG_FUNCTION_INFO_V1(ethiopian_date_set_in);
+
+Datum
+ethiopian_date_set_in(PG_FUNCTION_ARGS)
+{
+    char *str = PG_GETARG_CSTRING(0);
+    const char *p = str;
+    const char *end = str + strlen(str);
+    int capacity = 64;
+    int count = 0;
+    DateADT *days = (DateADT *) palloc(sizeof(DateADT) * capacity);
+
+    while (p < end && isspace((unsigned char) *p))
+        p++;
+    if (p >= end || *p++ != '{')
+        report_bad_date_set(str);
+    while (p < end && isspace((unsigned char) *p))
+        p++;
+
+    if (p < end && *p == '}')
+        p++;
+    else
+    {
+        for (;;)
+        {
+            DateADT from, to;
+
+            while (p < end && isspace((unsigned char) *p))
+                p++;
+            if (!scan_iso_date(&p, end, &from))
+                report_bad_date_set(str);
+            to = from;
+
+            if (end - p >= 2 && p[0] == '.' && p[1] == '.')
+            {
+                p += 2;
+                if (!scan_iso_date(&p, end, &to) || to < from)
+                    report_bad_date_set(str);
+            }
+            days = date_set_append_range(days, &count, &capacity, from, to);
+
+            while (p < end && isspace((unsigned char) *p))
+                p++;
+            if (p < end && *p == ',')
+            {
+                p++;
+                continue;
+            }
+            if (p < end && *p == '}')
+            {
+                p++;
+                break;
+            }
+            report_bad_date_set(str);
+        }
+    }
+
+    while (p < end && isspace((unsigned char) *p))
+        p++;
+    if (p != end)
+        report_bad_date_set(str);
+
+    count = date_set_sort_days(days, count);
+    PG_RETURN_POINTER(date_set_build(days, count));
+}
+
+/*
+ * PostgreSQL function: ethiopian_date_set_out(ethiopian_date_set)
+ */
+PG_FUNCTION_INFO_V1(ethiopian_date_set_out);
+
+Datum
+ethiopian_date_set_out(PG_FUNCTION_ARGS)
+{
+    EthiopianDateSet *set = PG_GETARG_DATE_SET_P(0);
+    DateADT *days = date_set_days(set);
+    StringInfoData buf;
+    int i = 0;
+
+    initStringInfo(&buf);
+    appendStringInfoChar(&buf, '{');
+
+    while (i < set->count)
+    {
+        int run_end = i;
+
+        while (run_end + 1 < set->count && days[run_end + 1] == days[run_end] + 1)
+            run_end++;
+
+        if (i > 0)
+            appendStringInfoChar(&buf, ',');
+        append_iso_date(&buf, days[i]);
+        if (run_end > i)
+        {
+            appendStringInfoString(&buf, "..");
+            append_iso_date(&buf, days[run_end]);
+        }
+        i = run_end + 1;
+    }
+
+    appendStringInfoChar(&buf, '}');
+    PG_RETURN_CSTRING(buf.data);
+}
+
+/*
+ * PostgreSQL function: ethiopian_date_set_recv(internal)
+ * 
+ * Binary input: count, then the days as int32 in ascending order.
+ */
+PG_FUNCTION_INFO_V1(ethiopian_date_set_recv);
+
+Datum
+ethiopian_date_set_recv(PG_FUNCTION_ARGS)
+{
+    StringInfo buf = (StringInfo) PG_GETARG_POINTER(0);
+    int count = (int) pq_getmsgint(buf, 4);
+    DateADT *days;
+    int i;
+
+    if (count < 0 || count > DATE_SET_MAX_DAYS)
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+                 errmsg("invalid ethiopian_date_set day count: %d", count)));
+
+    days = (DateADT *) palloc(sizeof(DateADT) * Max(count, 1));
+    for (i = 0; i < count; i++)
+    {
+        days[i] = (DateADT) pq_getmsgint(buf, 4);
+        if (i > 0 && days[i] <= days[i - 1])
+            ereport(ERROR,
+                    (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+                     errmsg("ethiopian_date_set days must be in ascending order")));
+    }
+
+    PG_RETURN_POINTER(date_set_build(days, count));
+}
+
+/*
+ * PostgreSQL function: ethiopian_date_set_send(ethiopian_date_set)
+ */
+PG_FUNCTION_INFO_V1(ethiopian_date_set_send);
+
+Datum
+ethiopian_date_set_send(PG_FUNCTION_ARGS)
+{
+    EthiopianDateSet *set = PG_GETARG_DATE_SET_P(0);
+    DateADT *days = date_set_days(set);
+    StringInfoData buf;
+    int i;
+
+    pq_begintypsend(&buf);
+    pq_sendint32(&buf, (uint32) set->count);
+    for (i = 0; i < set->count; i++)
+        pq_sendint32(&buf, (uint32) days[i]);
+
+    PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+/*
+ * PostgreSQL function: ethiopian_date_set(date[])
+ * 
+ * Builds a set from a date array (also the date[] -> ethiopian_date_set
+ * cast). NULL elements are ignored; dates outside
+ * 0001-01-01 .. 9999-12-31, infinity included, are rejected.
+ */
+PG_FUNCTION_INFO_V1(ethiopian_date_set_from_dates);
+
+Datum
+ethiopian_date_set_from_dates(PG_FUNCTION_ARGS)
+{
+    ArrayType *input = PG_GETARG_ARRAYTYPE_P(0);
+    Datum *elems;
+    bool *nulls;
+    int nelems;
+    DateADT *days;
+    int count = 0;
+    int i;
+
+    deconstruct_array(input, DATEOID, sizeof(DateADT), true, 'i', &elems, &nulls, &nelems);
+
+    days = (DateADT *) palloc(sizeof(DateADT) * Max(nelems, 1));
+    for (i = 0; i < nelems; i++)
+    {
+        if (nulls[i])
+            continue;
+
+        days[count++] = DatumGetDateADT(elems[i]);
+    }
+
+    count = date_set_sort_days(days, count);
+    PG_RETURN_POINTER(date_set_build(days, count));
+}
+
+/*
+ * PostgreSQL function: ethiopian_date_set(text, text, integer[])
+ * 
+ * Builds a set from an inclusive Ethiopian date range, optionally keeping
+ * only some days of the week (0 = Sunday ... 6 = Saturday, as in
+ * ethiopian_day_of_week()). Not STRICT so days_of_week can default to NULL.
+ * 
+ * Parameters:
+ *   from_date, to_date: Ethiopian calendar dates (format: YYYY-MM-DD)
+ *   days_of_week: days to keep, or NULL for every day
+ * 
+ * Returns: ETHIOPIAN_DATE_SET (NULL if either bound is NULL)
+ */
+PG_FUNCTION_INFO_V1(ethiopian_date_set_from_range);
+
+Datum
+ethiopian_date_set_from_range(PG_FUNCTION_ARGS)
+{
+    bool keep[7] = {true, true, true, true, true, true, true};
+    int jdns[2];
+    int arg;
+    DateADT *days;
+    int count = 0;
+    int jdn;
+
+    if (PG_ARGISNULL(0) || PG_ARGISNULL(1))
+        PG_RETURN_NULL();
+
+    for (arg = 0; arg < 2; arg++)
+    {
+        text *date_text = PG_GETARG_TEXT_PP(arg);
+        int eth_year, eth_month, eth_day;
+
+        parse_ethiopian_date(VARDATA_ANY(date_text), VARSIZE_ANY_EXHDR(date_text),
+                             &eth_year, &eth_month, &eth_day);
+        jdns[arg] = ethiopian_to_jdn(eth_year, eth_month, eth_day);
+        if (jdns[arg] < ETHIOPIAN_EPOCH)
+            report_before_epoch();
+    }
+
+    if (!PG_ARGISNULL(2))
+    {
+        Datum *elems;
+        bool *nulls;
+        int nelems;
+        int i;
+
+        deconstruct_array(PG_GETARG_ARRAYTYPE_P(2), INT4OID, sizeof(int32), true, 'i',
+                          &elems, &nulls, &nelems);
+
+        memset(keep, 0, sizeof(keep));
+        for (i = 0; i < nelems; i++)
+        {
+            int dow;
+
+            if (nulls[i])
+                continue;
+
+            dow = DatumGetInt32(elems[i]);
+            if (dow < 0 || dow > 6)
+                ereport(ERROR,
+                        (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                         errmsg("invalid day of week: %d (must be 0-6, 0 = Sunday)", dow)));
+            keep[dow] = true;
+        }
+    }
+
+    if (jdns[1] - jdns[0] >= DATE_SET_MAX_DAYS)
+        report_date_set_too_large();
+
+    days = (DateADT *) palloc(sizeof(DateADT) * Max(jdns[1] - jdns[0] + 1, 1));
+    for (jdn = jdns[0]; jdn <= jdns[1]; jdn++)
+    {
+        /* JDN 0 was a Monday */
+        if (keep[(jdn + 1) % 7])
+            days[count++] = jdn - POSTGRES_EPOCH_JDATE;
+    }
+
+    PG_RETURN_POINTER(date_set_build(days, count));
+}
+
+/*
+ * PostgreSQL functions: ethiopian_date_set_contains(ethiopian_date_set, date),
+ * ethiopian_date_set_contains_timestamp(ethiopian_date_set, timestamp) and
+ * ethiopian_date_set_contained(date, ethiopian_date_set)
+ * 
+ * Membership tests behind the @> and <@ operators. A timestamp matches the
+ * day it falls on.
+ */
+PG_FUNCTION_INFO_V1(ethiopian_date_set_contains);
+
+Datum
+ethiopian_date_set_contains(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_BOOL(date_set_contains(PG_GETARG_DATE_SET_P(0), PG_GETARG_DATEADT(1)));
+}
+
+PG_FUNCTION_INFO_V1(ethiopian_date_set_contains_timestamp);
+
+Datum
+ethiopian_date_set_contains_timestamp(PG_FUNCTION_ARGS)
+{
+    Timestamp timestamp_val = PG_GETARG_TIMESTAMP(1);
+
+    if (TIMESTAMP_NOT_FINITE(timestamp_val))
+        PG_RETURN_BOOL(false);
+
+    PG_RETURN_BOOL(date_set_contains(PG_GETARG_DATE_SET_P(0),
+                                     timestamp_to_jdn(timestamp_val) - POSTGRES_EPOCH_JDATE));
+}
+
+PG_FUNCTION_INFO_V1(ethiopian_date_set_contained);
+
+Datum
+ethiopian_date_set_contained(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_BOOL(date_set_contains(PG_GETARG_DATE_SET_P(1), PG_GETARG_DATEADT(0)));
+}
+
+/*
+ * PostgreSQL functions: ethiopian_date_set_union and
+ * ethiopian_date_set_intersect (operators | and &)
+ * 
+ * Both merge the decoded day lists, O(n + m).
+ */
+PG_FUNCTION_INFO_V1(ethiopian_date_set_union);
+
+Datum
+ethiopian_date_set_union(PG_FUNCTION_ARGS)
+{
+    EthiopianDateSet *a = PG_GETARG_DATE_SET_P(0);
+    EthiopianDateSet *b = PG_GETARG_DATE_SET_P(1);
+    DateADT *a_days = date_set_days(a);
+    DateADT *b_days = date_set_days(b);
+    DateADT *days = (DateADT *) palloc(sizeof(DateADT) * Max(a->count + b->count, 1));
+    int i = 0, j = 0, count = 0;
+
+    while (i < a->count || j < b->count)
+    {
+        if (j >= b->count || (i < a->count && a_days[i] < b_days[j]))
+            days[count++] = a_days[i++];
+        else if (i >= a->count || b_days[j] < a_days[i])
+            days[count++] = b_days[j++];
+        else
+        {
+            days[count++] = a_days[i++];
+            j++;
+        }
+    }
+
+    PG_RETURN_POINTER(date_set_build(days, count));
+}
+
+PG_FUNCTION_INFO_V1(ethiopian_date_set_intersect);
+
+Datum
+ethiopian_date_set_intersect(PG_FUNCTION_ARGS)
+{
+    EthiopianDateSet *a = PG_GETARG_DATE_SET_P(0);
+    EthiopianDateSet *b = PG_GETARG_DATE_SET_P(1);
+    DateADT *a_days = date_set_days(a);
+    DateADT *b_days = date_set_days(b);
+    DateADT *days = (DateADT *) palloc(sizeof(DateADT) * Max(Min(a->count, b->count), 1));
+    int i = 0, j = 0, count = 0;
+
+    while (i < a->count && j < b->count)
+    {
+        if (a_days[i] < b_days[j])
+            i++;
+        else if (b_days[j] < a_days[i])
+            j++;
+        else
+        {
+            days[count++] = a_days[i++];
+            j++;
+        }
+    }
+
+    PG_RETURN_POINTER(date_set_build(days, count));
+}
+
+/*
+ * PostgreSQL function: ethiopian_date_set_count(ethiopian_date_set)
+ * 
+ * Returns: INTEGER (number of days in the set)
+ */
+PG_FUNCTION_INFO_V1(ethiopian_date_set_count);
+
+Datum
+ethiopian_date_set_count(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_INT32(PG_GETARG_DATE_SET_P(0)->count);
+}
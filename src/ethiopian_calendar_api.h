@@ -0,0 +1,101 @@
+/*
+ * ethiopian_calendar_api.h
+ *
+ * C API for other PostgreSQL extensions that need Ethiopian calendar
+ * conversions without going through the fmgr interface.
+ *
+ * Dates are PostgreSQL day numbers (DateADT: days since 2000-01-01), so a
+ * DATE column value can be passed as-is and a TIMESTAMP value after dividing
+ * by USECS_PER_DAY (rounding down). Ethiopian dates are plain year, month and
+ * day integers; no text or Datum is allocated.
+ *
+ * Usage from another extension:
+ *
+ *   #include "extension/ethiopian_calendar/ethiopian_calendar_api.h"
+ *
+ *   const EthiopianCalendarApi *api = ethiopian_calendar_api_load();
+ *   int year, month, day;
+ *
+ *   if (api->date_to_ethiopian(date, &year, &month, &day))
+ *       ...
+ *
+ * The struct is versioned: members are only ever appended, and
+ * ETHIOPIAN_CALENDAR_API_VERSION is bumped when that happens. Check
+ * api->version before using members added after version 1.
+ */
+
+#ifndef ETHIOPIAN_CALENDAR_API_H
+#define ETHIOPIAN_CALENDAR_API_H
+
+#include "fmgr.h"
+#include "utils/date.h"
+
+#define ETHIOPIAN_CALENDAR_API_VERSION 1
+
+/* Name of the rendezvous variable holding a pointer to the API struct */
+#define ETHIOPIAN_CALENDAR_API_RENDEZVOUS "ethiopian_calendar_api"
+
+typedef struct EthiopianCalendarApi
+{
+    int version;                /* ETHIOPIAN_CALENDAR_API_VERSION */
+    Size size;                  /* sizeof(EthiopianCalendarApi) in the library */
+
+    /* Earliest convertible date: the Ethiopian epoch, August 29, 8 CE */
+    DateADT min_date;
+
+    /*
+     * Scalar conversions. Return false (leaving outputs undefined) for dates
+     * before min_date, infinite dates and invalid Ethiopian dates.
+     */
+    bool (*date_to_ethiopian) (DateADT date, int *year, int *month, int *day);
+    bool (*ethiopian_to_date) (int year, int month, int day, DateADT *date);
+    bool (*is_leap_year) (int year);
+
+    /*
+     * Write date as "YYYY-MM-DD" (Ethiopian) into buf, which must hold at
+     * least 16 bytes. Returns the string length, or 0 if date is out of range.
+     */
+    int (*format_date) (DateADT date, char *buf);
+
+    /*
+     * Batch conversions over count elements. Invalid elements get 0 for
+     * year/month/day (respectively DATEVAL_NOBEGIN); the return value is the
+     * number of invalid elements, so 0 means everything was converted.
+     */
+    int (*dates_to_ethiopian) (const DateADT *dates, int count,
+                               int *years, int *months, int *days);
+    int (*ethiopian_to_dates) (const int *years, const int *months, const int *days,
+                               int count, DateADT *dates);
+} EthiopianCalendarApi;
+
+/*
+ * Exported by the ethiopian_calendar library; also published through the
+ * ETHIOPIAN_CALENDAR_API_RENDEZVOUS rendezvous variable when it is loaded.
+ */
+typedef const EthiopianCalendarApi *(*ethiopian_calendar_get_api_type) (void);
+
+/*
+ * Load the ethiopian_calendar library if needed and return its API.
+ * Raises an error if the installed library is too old.
+ */
+static inline const EthiopianCalendarApi *
+ethiopian_calendar_api_load(void)
+{
+    const EthiopianCalendarApi *api;
+    ethiopian_calendar_get_api_type get_api;
+
+    get_api = (ethiopian_calendar_get_api_type)
+        load_external_function("$libdir/ethiopian_calendar",
+                               "ethiopian_calendar_get_api", true, NULL);
+    api = get_api();
+
+    if (api == NULL || api->version < ETHIOPIAN_CALENDAR_API_VERSION)
+        ereport(ERROR,
+                (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+                 errmsg("installed ethiopian_calendar library provides API version %d, version %d is required",
+                        api ? api->version : 0, ETHIOPIAN_CALENDAR_API_VERSION)));
+
+    return api;
+}
+
+#endif                          /* ETHIOPIAN_CALENDAR_API_H */
@@ -0,0 +1,333 @@
+/*
+ * ethiopian_core.h
+ *
+ * Calendar kernels shared by the PostgreSQL extension (ethiopian_calendar.c)
+ * and the Node.js native addon (npm/native). Plain C with no PostgreSQL
+ * dependencies, so both builds produce identical results.
+ */
+
+#ifndef ETHIOPIAN_CORE_H
+#define ETHIOPIAN_CORE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Ethiopian calendar epoch: August 29, 8 CE in Gregorian calendar
+ * This corresponds to JDN 1724221
+ */
+#define ETHIOPIAN_EPOCH 1724221
+
+/*
+ * Convert Gregorian date to Julian Day Number
+ * 
+ * Algorithm from "Calendrical Calculations" by Dershowitz & Reingold
+ * 
+ * Parameters:
+ *   year, month, day: Gregorian calendar components
+ * 
+ * Returns: Julian Day Number
+ */
+static inline int
+gregorian_to_jdn(int year, int month, int day)
+{
+    int a, y, m, jdn;
+
+    /* Adjust for month/year if month is January or February */
+    a = (14 - month) / 12;
+    y = year + 4800 - a;
+    m = month + 12 * a - 3;
+
+    /* Calculate Julian Day Number */
+    jdn = day + (153 * m + 2) / 5 + 365 * y + y / 4 - y / 100 + y / 400 - 32045;
+
+    return jdn;
+}
+
+/*
+ * Convert Julian Day Number to Gregorian date
+ * 
+ * Algorithm from "Calendrical Calculations" by Dershowitz & Reingold
+ * 
+ * Parameters:
+ *   jdn: Julian Day Number
+ *   year, month, day: Output parameters for Gregorian date components
+ */
+static inline void
+jdn_to_gregorian(int jdn, int *year, int *month, int *day)
+{
+    int a, b, c, d, e, m;
+
+    a = jdn + 32044;
+    b = (4 * a + 3) / 146097;
+    c = a - (b * 146097) / 4;
+    d = (4 * c + 3) / 1461;
+    e = c - (1461 * d) / 4;
+    m = (5 * e + 2) / 153;
+
+    *day = e - (153 * m + 2) / 5 + 1;
+    *month = m + 3 - 12 * (m / 10);
+    *year = b * 100 + d - 4800 + (m / 10);
+}
+
+/*
+ * Convert Julian Day Number to Ethiopian calendar date
+ * 
+ * Algorithm from "Calendrical Calculations" by Dershowitz & Reingold
+ * Chapter 4: Ethiopian Calendar
+ * 
+ * The Ethiopian calendar has:
+ *   - 12 months of 30 days each (months 1-12: Meskerem, Tikimt, Hidar, Tahsas, etc.)
+ *   - 1 month of 5 or 6 days (month 13, Pagumē)
+ *   - Leap years have 6 days in month 13, regular years have 5
+ *   - Leap years occur every 4 years (years where year % 4 == 3)
+ *   - Year 1 in Ethiopian calendar started on August 29, 8 CE (Gregorian)
+ * 
+ * Formula from Calendrical Calculations:
+ *   era = floor((jdn - ETHIOPIAN_EPOCH) / 1461)
+ *   year_of_era = floor(((jdn - ETHIOPIAN_EPOCH) mod 1461) / 365)
+ *   day_of_year = ((jdn - ETHIOPIAN_EPOCH) mod 1461) mod 365
+ *   
+ *   If year_of_era == 4, then year_of_era = 3 and day_of_year = 365
+ *   
+ *   year = 4 * era + year_of_era + 1
+ *   
+ *   month = floor(day_of_year / 30) + 1  (if day_of_year < 360)
+ *   day = (day_of_year mod 30) + 1
+ *   
+ *   If day_of_year >= 360, then month = 13 and day = day_of_year - 360 + 1
+ * 
+ * Parameters:
+ *   jdn: Julian Day Number
+ *   year, month, day: Output parameters for Ethiopian date components
+ */
+static inline void
+jdn_to_ethiopian(int jdn, int *year, int *month, int *day)
+{
+    int era, year_of_era, day_of_year;
+    int days_since_epoch;
+    
+    /* Calculate days since Ethiopian epoch */
+    days_since_epoch = jdn - ETHIOPIAN_EPOCH;
+    
+    /* Calculate era (4-year cycles) */
+    era = days_since_epoch / 1461;
+    
+    /* Calculate year within the era (0-3) */
+    year_of_era = (days_since_epoch % 1461) / 365;
+    
+    /* Calculate day of year (0-365) */
+    day_of_year = (days_since_epoch % 1461) % 365;
+    
+    /* Handle the 4th year of the era (leap year with 366 days) */
+    if (year_of_era == 4)
+    {
+        year_of_era = 3;
+        day_of_year = 365;
+    }
+    
+    /* Calculate Ethiopian year */
+    *year = 4 * era + year_of_era + 1;
+    
+    /* Calculate month and day */
+    if (day_of_year < 360)
+    {
+        /* Months 1-12: each has 30 days */
+        *month = day_of_year / 30 + 1;
+        *day = (day_of_year % 30) + 1;
+    }
+    else
+    {
+        /* Month 13 (Pagumē): 5 or 6 days */
+        int is_leap;
+        int max_days;
+        
+        *month = 13;
+        *day = day_of_year - 360 + 1;
+        
+        /* Validate: month 13 has 5 days in regular years, 6 in leap years */
+        /* Leap years: year % 4 == 3 */
+        is_leap = (*year % 4 == 3);
+        max_days = is_leap ? 6 : 5;
+        
+        if (*day > max_days)
+        {
+            *day = max_days;
+        }
+    }
+}
+
+/*
+ * Convert Ethiopian calendar date to Julian Day Number
+ * 
+ * Algorithm from "Calendrical Calculations" by Dershowitz & Reingold
+ * Inverse of jdn_to_ethiopian
+ * 
+ * Formula:
+ *   era = floor((year - 1) / 4)
+ *   year_of_era = (year - 1) mod 4
+ *   
+ *   If month <= 12:
+ *     day_of_year = (month - 1) * 30 + day - 1
+ *   Else (month == 13):
+ *     day_of_year = 360 + day - 1
+ *   
+ *   jdn = ETHIOPIAN_EPOCH + era * 1461 + year_of_era * 365 + day_of_year
+ * 
+ * Parameters:
+ *   year, month, day: Ethiopian calendar components
+ * 
+ * Returns: Julian Day Number
+ */
+static inline int
+ethiopian_to_jdn(int year, int month, int day)
+{
+    int era, year_of_era, day_of_year, jdn;
+    
+    /* Calculate era (4-year cycles) and year within era */
+    era = (year - 1) / 4;
+    year_of_era = (year - 1) % 4;
+    
+    /* Calculate day of year (0-based) */
+    if (month <= 12)
+    {
+        /* Months 1-12: each has 30 days */
+        day_of_year = (month - 1) * 30 + (day - 1);
+    }
+    else
+    {
+        /* Month 13 (Pagumē): days 360-365 (or 360-366 in leap years) */
+        day_of_year = 360 + (day - 1);
+    }
+    
+    /* Calculate Julian Day Number */
+    jdn = ETHIOPIAN_EPOCH + era * 1461 + year_of_era * 365 + day_of_year;
+    
+    return jdn;
+}
+
+/*
+ * Convert count Ethiopian dates to Julian Day Numbers
+ * 
+ * Same result as ethiopian_to_jdn() for each element. (month - 1) * 30 also
+ * gives day 360 for Pagumē, so the loop body has no branches and compilers
+ * can vectorise it. Components must already be validated.
+ */
+static inline void
+ethiopian_to_jdn_batch(const int *years, const int *months, const int *days,
+                       int count, int *jdns)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+        jdns[i] = ETHIOPIAN_EPOCH + ((years[i] - 1) / 4) * 1461 +
+            ((years[i] - 1) % 4) * 365 + (months[i] - 1) * 30 + (days[i] - 1);
+}
+
+/*
+ * Check Ethiopian date components, using the same rules as from_ethiopian_date()
+ * plus year >= 1
+ * 
+ * Returns: 1 if valid, 0 otherwise
+ */
+static inline int
+ethiopian_date_is_valid(int year, int month, int day)
+{
+    if (year < 1 || month < 1 || month > 13 || day < 1)
+        return 0;
+    if (month <= 12)
+        return day <= 30;
+    return day <= ((year % 4 == 3) ? 6 : 5);
+}
+
+/*
+ * Write an Ethiopian date as "YYYY-MM-DD" (years above 9999 get more digits)
+ * followed by a NUL; buf needs ETHIOPIAN_DATE_BUFLEN bytes. Same output as
+ * snprintf("%04d-%02d-%02d") for year >= 0 and valid month and day.
+ * 
+ * Returns: the length without the NUL
+ */
+#define ETHIOPIAN_DATE_BUFLEN 16
+
+static inline int
+format_ethiopian_date(char *buf, int year, int month, int day)
+{
+    char *p = buf;
+
+    if (year > 9999)
+        p += sprintf(p, "%d", year);
+    else
+    {
+        p[0] = '0' + year / 1000;
+        p[1] = '0' + year / 100 % 10;
+        p[2] = '0' + year / 10 % 10;
+        p[3] = '0' + year % 10;
+        p += 4;
+    }
+    p[0] = '-';
+    p[1] = '0' + month / 10;
+    p[2] = '0' + month % 10;
+    p[3] = '-';
+    p[4] = '0' + day / 10;
+    p[5] = '0' + day % 10;
+    p[6] = '\0';
+
+    return (int) (p - buf) + 6;
+}
+
+/*
+ * Parse a fixed-layout "YYYY-MM-DD" Ethiopian date with SWAR arithmetic
+ * 
+ * The eight digits are gathered into one 64-bit word with one digit per
+ * byte lane, checked for '0'..'9' in all lanes at once and then combined
+ * pairwise into two-digit values, so the common case needs neither
+ * sscanf() nor a loop over characters. Whenever it accepts a string,
+ * sscanf("%d-%d-%d") gives the same components (see test/fuzz).
+ * 
+ * Returns: 0 for anything else (other lengths, signs, spaces, big-endian
+ * hosts); the caller then uses the scalar parser.
+ */
+static inline int
+parse_fixed_ethiopian_date(const char *str, int len,
+                           int *year, int *month, int *day)
+{
+#if defined(WORDS_BIGENDIAN) || \
+    (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    return 0;
+#else
+    uint64_t head;
+    uint16_t tail;
+    uint64_t digits;
+
+    if (len != 10)
+        return 0;
+
+    memcpy(&head, str, sizeof(head));       /* "YYYY-MM-" */
+    memcpy(&tail, str + 8, sizeof(tail));   /* "DD" */
+
+    if (((head >> 32) & 0xFF) != '-' || (head >> 56) != '-')
+        return 0;
+
+    /* Lanes Y Y Y Y M M D D, first character in the lowest byte */
+    digits = (head & 0x00000000FFFFFFFFULL) |
+        ((head & 0x00FFFF0000000000ULL) >> 8) |
+        ((uint64_t) tail << 48);
+
+    /* '0'..'9' is 0x30..0x39: high nibble 3, and still 3 after adding 6 */
+    if ((digits & 0xF0F0F0F0F0F0F0F0ULL) != 0x3030303030303030ULL ||
+        ((digits + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) != 0x3030303030303030ULL)
+        return 0;
+
+    /* Each 16-bit lane becomes tens * 10 + units */
+    digits &= 0x0F0F0F0F0F0F0F0FULL;
+    digits = (digits * 10 + (digits >> 8)) & 0x00FF00FF00FF00FFULL;
+
+    *year = (int) (digits & 0xFF) * 100 + (int) ((digits >> 16) & 0xFF);
+    *month = (int) ((digits >> 32) & 0xFF);
+    *day = (int) (digits >> 48);
+    return 1;
+#endif
+}
+
+#endif                          /* ETHIOPIAN_CORE_H */
@@ -0,0 +1,24 @@
+/*
+ * ethiopian_engine.h
+ *
+ * Conversion engine selected by ethiopian_calendar.engine (see
+ * ethiopian_calendar.c), exposed so statistics can be kept per engine.
+ */
+
+#ifndef ETHIOPIAN_ENGINE_H
+#define ETHIOPIAN_ENGINE_H
+
+typedef enum EthiopianEngine
+{
+    ETHIOPIAN_ENGINE_AUTO,
+    ETHIOPIAN_ENGINE_REFERENCE,
+    ETHIOPIAN_ENGINE_FAST,
+    ETHIOPIAN_ENGINE_LOOKUP
+} EthiopianEngine;
+
+/* The engine in use, with auto already resolved */
+extern int ethiopian_engine_current(void);
+
+extern const char *ethiopian_engine_name(int engine);
+
+#endif                          /* ETHIOPIAN_ENGINE_H */
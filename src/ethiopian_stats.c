@@ -0,0 +1,667 @@
+/*
+ * ethiopian_stats.c
+ *
+ * Per-query accounting of Ethiopian calendar function calls.
+ *
+ * When the library is loaded through shared_preload_libraries and
+ * ethiopian_calendar.track is on, every call of an extension C function is
+ * counted per (database, queryid, function, conversion engine), with
+ * the number of calls that raised an error and, if
+ * ethiopian_calendar.track_timing is on, the total time spent in the function.
+ * The queryid is the same one pg_stat_statements reports, so the two views
+ * can be joined to find the statements that spend the most time converting.
+ *
+ * Calls are intercepted with the fmgr hook, so the conversion functions
+ * themselves carry no accounting code. The hook is not free (the call runs
+ * inside fmgr_security_definer's exception block and looks up two hash
+ * entries), which is why tracking is off by default. Counters are first collected in
+ * backend-local memory and merged into the shared hash table when an
+ * executor run ends, so the shared lock is taken once per statement, not
+ * once per row.
+ */
+
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "catalog/pg_language.h"
+#include "catalog/pg_proc.h"
+#include "catalog/pg_type.h"
+#include "executor/executor.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "portability/instr_time.h"
+#include "storage/ipc.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/hsearch.h"
+#include "utils/syscache.h"
+#include "utils/tuplestore.h"
+#if PG_VERSION_NUM >= 160000
+#include "nodes/queryjumble.h"
+#elif PG_VERSION_NUM >= 140000
+#include "utils/queryjumble.h"
+#endif
+
+#include "ethiopian_engine.h"
+#include "ethiopian_stats.h"
+
+/*
+ * Shared hash table key: one entry per function per statement per database,
+ * split by ethiopian_calendar.engine so engines can be compared
+ */
+typedef struct EthiopianStatsKey
+{
+    Oid dbid;
+    Oid funcid;
+    int64 queryid;
+    int engine;
+} EthiopianStatsKey;
+
+/*
+ * Shared hash table entry
+ */
+typedef struct EthiopianStatsEntry
+{
+    EthiopianStatsKey key;
+    int64 calls;
+    int64 errors;
+    double total_time;          /* milliseconds, only with track_timing */
+} EthiopianStatsEntry;
+
+/*
+ * Shared state, protected by lock
+ */
+typedef struct EthiopianStatsSharedState
+{
+    LWLock *lock;
+} EthiopianStatsSharedState;
+
+/*
+ * Backend-local counters for one function, not yet merged into shared memory
+ */
+typedef struct EthiopianStatsPending
+{
+    Oid funcid;
+    int64 calls;
+    int64 errors;
+    instr_time time;
+} EthiopianStatsPending;
+
+/*
+ * Backend-local cache of whether a function OID belongs to this extension
+ */
+typedef struct EthiopianFunctionCacheEntry
+{
+    Oid funcid;
+    bool tracked;
+} EthiopianFunctionCacheEntry;
+
+/*
+ * Per-call-site state of stats_fmgr_hook, allocated on the first call
+ */
+typedef struct EthiopianStatsCallState
+{
+    Datum prev_private;         /* *private of the previous fmgr_hook */
+    bool tracked;               /* one of this extension's functions */
+    bool counting;              /* the current call is being counted */
+    instr_time start;           /* zero unless the call is being timed */
+} EthiopianStatsCallState;
+
+/* Upper bound on distinct extension functions tracked between flushes */
+#define STATS_MAX_PENDING 64
+
+/* GUC variables */
+static bool stats_track = false;
+static bool stats_track_timing = false;
+static int stats_max = 5000;
+
+/* Shared memory */
+static EthiopianStatsSharedState *stats_shared = NULL;
+static HTAB *stats_hash = NULL;
+
+/* Backend-local state */
+static EthiopianStatsPending stats_pending[STATS_MAX_PENDING];
+static int stats_num_pending = 0;
+static bool stats_pending_dirty = false;
+static EthiopianStatsPending *stats_last_pending = NULL;
+static int64 stats_current_queryid = 0;
+static HTAB *stats_function_cache = NULL;
+
+/* Saved hook values */
+#if PG_VERSION_NUM >= 150000
+static shmem_request_hook_type prev_shmem_request_hook = NULL;
+#endif
+static shmem_startup_hook_type prev_shmem_startup_hook = NULL;
+static ExecutorRun_hook_type prev_ExecutorRun = NULL;
+static ExecutorFinish_hook_type prev_ExecutorFinish = NULL;
+static needs_fmgr_hook_type prev_needs_fmgr_hook = NULL;
+static fmgr_hook_type prev_fmgr_hook = NULL;
+
+/*
+ * Shared memory needed for the stats hash table
+ */
+static Size
+stats_memsize(void)
+{
+    return add_size(MAXALIGN(sizeof(EthiopianStatsSharedState)),
+                    hash_estimate_size(stats_max, sizeof(EthiopianStatsEntry)));
+}
+
+#if PG_VERSION_NUM >= 150000
+/*
+ * shmem_request_hook: reserve shared memory and the LWLock
+ */
+static void
+stats_shmem_request(void)
+{
+    if (prev_shmem_request_hook)
+        prev_shmem_request_hook();
+
+    RequestAddinShmemSpace(stats_memsize());
+    RequestNamedLWLockTranche("ethiopian_calendar", 1);
+}
+#endif
+
+/*
+ * shmem_startup_hook: create or attach to the shared hash table
+ */
+static void
+stats_shmem_startup(void)
+{
+    HASHCTL info;
+    bool found;
+
+    if (prev_shmem_startup_hook)
+        prev_shmem_startup_hook();
+
+    LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+
+    stats_shared = ShmemInitStruct("ethiopian_calendar stats",
+                                   sizeof(EthiopianStatsSharedState),
+                                   &found);
+    if (!found)
+        stats_shared->lock = &(GetNamedLWLockTranche("ethiopian_calendar"))->lock;
+
+    memset(&info, 0, sizeof(info));
+    info.keysize = sizeof(EthiopianStatsKey);
+    info.entrysize = sizeof(EthiopianStatsEntry);
+    stats_hash = ShmemInitHash("ethiopian_calendar stats hash",
+                               stats_max, stats_max,
+                               &info,
+                               HASH_ELEM | HASH_BLOBS);
+
+    LWLockRelease(AddinShmemInitLock);
+}
+
+/*
+ * Return the backend-local counters for a function, adding a slot if needed
+ */
+static EthiopianStatsPending *
+stats_pending_entry(Oid funcid)
+{
+    int i;
+
+    if (stats_last_pending != NULL && stats_last_pending->funcid == funcid)
+        return stats_last_pending;
+
+    for (i = 0; i < stats_num_pending; i++)
+    {
+        if (stats_pending[i].funcid == funcid)
+            return stats_last_pending = &stats_pending[i];
+    }
+
+    if (stats_num_pending >= STATS_MAX_PENDING)
+        return NULL;
+
+    stats_last_pending = &stats_pending[stats_num_pending++];
+    memset(stats_last_pending, 0, sizeof(EthiopianStatsPending));
+    stats_last_pending->funcid = funcid;
+
+    return stats_last_pending;
+}
+
+/*
+ * Merge backend-local counters into the shared hash table under queryid
+ */
+static void
+stats_flush(int64 queryid)
+{
+    int i;
+
+    if (!stats_pending_dirty)
+        return;
+
+    if (stats_shared != NULL && stats_hash != NULL)
+    {
+        LWLockAcquire(stats_shared->lock, LW_EXCLUSIVE);
+
+        for (i = 0; i < stats_num_pending; i++)
+        {
+            EthiopianStatsPending *pending = &stats_pending[i];
+            EthiopianStatsKey key;
+            EthiopianStatsEntry *entry;
+            bool found;
+
+            if (pending->calls == 0 && pending->errors == 0)
+                continue;
+
+            memset(&key, 0, sizeof(key));
+            key.dbid = MyDatabaseId;
+            key.funcid = pending->funcid;
+            key.queryid = queryid;
+            key.engine = ethiopian_engine_current();
+
+            /* When the table is full, new statements are not tracked */
+            entry = (EthiopianStatsEntry *) hash_search(stats_hash, &key, HASH_ENTER_NULL, &found);
+            if (entry == NULL)
+                continue;
+
+            if (!found)
+            {
+                entry->calls = 0;
+                entry->errors = 0;
+                entry->total_time = 0.0;
+            }
+
+            entry->calls += pending->calls;
+            entry->errors += pending->errors;
+            entry->total_time += INSTR_TIME_GET_MILLISEC(pending->time);
+        }
+
+        LWLockRelease(stats_shared->lock);
+    }
+
+    for (i = 0; i < stats_num_pending; i++)
+    {
+        stats_pending[i].calls = 0;
+        stats_pending[i].errors = 0;
+        INSTR_TIME_SET_ZERO(stats_pending[i].time);
+    }
+    stats_pending_dirty = false;
+}
+
+/*
+ * Check whether a function is one of this extension's C functions
+ *
+ * Planner support functions (returning internal) and the
+ * ethiopian_calendar_* administrative functions are not tracked.
+ */
+static bool
+stats_is_tracked_function(Oid funcid)
+{
+    EthiopianFunctionCacheEntry *cache_entry;
+    HeapTuple proc_tuple;
+    bool found;
+
+    if (stats_function_cache == NULL)
+    {
+        HASHCTL info;
+
+        memset(&info, 0, sizeof(info));
+        info.keysize = sizeof(Oid);
+        info.entrysize = sizeof(EthiopianFunctionCacheEntry);
+        stats_function_cache = hash_create("ethiopian_calendar function cache", 64,
+                                           &info, HASH_ELEM | HASH_BLOBS);
+    }
+
+    cache_entry = (EthiopianFunctionCacheEntry *) hash_search(stats_function_cache, &funcid,
+                                                              HASH_ENTER, &found);
+    if (found)
+        return cache_entry->tracked;
+
+    cache_entry->tracked = false;
+
+    proc_tuple = SearchSysCache1(PROCOID, ObjectIdGetDatum(funcid));
+    if (HeapTupleIsValid(proc_tuple))
+    {
+        Form_pg_proc proc = (Form_pg_proc) GETSTRUCT(proc_tuple);
+
+        if (proc->prolang == ClanguageId &&
+            proc->prorettype != INTERNALOID &&
+            strncmp(NameStr(proc->proname), "ethiopian_calendar_", 19) != 0)
+        {
+            Datum probin_datum;
+            bool isnull;
+
+            probin_datum = SysCacheGetAttr(PROCOID, proc_tuple, Anum_pg_proc_probin, &isnull);
+            if (!isnull)
+            {
+                char *probin = TextDatumGetCString(probin_datum);
+                size_t len = strlen(probin);
+                size_t suffix_len = strlen("ethiopian_calendar");
+
+                cache_entry->tracked = len >= suffix_len &&
+                    strcmp(probin + len - suffix_len, "ethiopian_calendar") == 0;
+                pfree(probin);
+            }
+        }
+        ReleaseSysCache(proc_tuple);
+    }
+
+    return cache_entry->tracked;
+}
+
+/*
+ * needs_fmgr_hook: route this extension's functions through stats_fmgr_hook
+ *
+ * Evaluated when a call site is set up (fmgr_info), so changing
+ * ethiopian_calendar.track affects statements planned afterwards.
+ */
+static bool
+stats_needs_fmgr_hook(Oid funcid)
+{
+    if (prev_needs_fmgr_hook && prev_needs_fmgr_hook(funcid))
+        return true;
+
+    if (!stats_track || stats_shared == NULL)
+        return false;
+
+    return stats_is_tracked_function(funcid);
+}
+
+/*
+ * fmgr_hook: count calls, errors and (optionally) time per function
+ *
+ * fmgr also sends functions here that other needs_fmgr_hook callers or
+ * SECURITY DEFINER and SET clauses selected, so whether to count a call is
+ * decided at FHET_START and kept in the call site's state, which *private
+ * points to. The previous hook keeps its own private value there too.
+ */
+static void
+stats_fmgr_hook(FmgrHookEventType event, FmgrInfo *flinfo, Datum *private)
+{
+    EthiopianStatsCallState *state = (EthiopianStatsCallState *) DatumGetPointer(*private);
+    EthiopianStatsPending *pending;
+
+    if (state == NULL)
+    {
+        state = (EthiopianStatsCallState *) MemoryContextAllocZero(flinfo->fn_mcxt,
+                                                                   sizeof(EthiopianStatsCallState));
+        state->tracked = stats_is_tracked_function(flinfo->fn_oid);
+        *private = PointerGetDatum(state);
+    }
+
+    if (prev_fmgr_hook)
+        prev_fmgr_hook(event, flinfo, &state->prev_private);
+
+    if (event == FHET_START)
+    {
+        state->counting = stats_track && state->tracked;
+        if (!state->counting)
+            return;
+
+        pending = stats_pending_entry(flinfo->fn_oid);
+        if (pending != NULL)
+        {
+            pending->calls++;
+            stats_pending_dirty = true;
+        }
+        if (stats_track_timing)
+            INSTR_TIME_SET_CURRENT(state->start);
+        else
+            INSTR_TIME_SET_ZERO(state->start);
+        return;
+    }
+
+    if (!state->counting)
+        return;
+    state->counting = false;
+
+    pending = stats_pending_entry(flinfo->fn_oid);
+    if (pending == NULL)
+        return;
+
+    if (event == FHET_ABORT)
+    {
+        pending->errors++;
+        stats_pending_dirty = true;
+    }
+
+    if (!INSTR_TIME_IS_ZERO(state->start))
+    {
+        instr_time now;
+
+        INSTR_TIME_SET_CURRENT(now);
+        INSTR_TIME_ACCUM_DIFF(pending->time, now, state->start);
+    }
+}
+
+/*
+ * ExecutorRun hook: attribute calls to the statement being executed
+ *
+ * Counters collected so far belong to the enclosing statement, so they are
+ * flushed before switching to the nested statement's queryid and again when
+ * it finishes (or fails).
+ */
+static void
+#if PG_VERSION_NUM >= 180000
+stats_ExecutorRun(QueryDesc *queryDesc, ScanDirection direction, uint64 count)
+#else
+stats_ExecutorRun(QueryDesc *queryDesc, ScanDirection direction, uint64 count, bool execute_once)
+#endif
+{
+    int64 saved_queryid = stats_current_queryid;
+
+    stats_flush(saved_queryid);
+    stats_current_queryid = (int64) queryDesc->plannedstmt->queryId;
+
+    PG_TRY();
+    {
+#if PG_VERSION_NUM >= 180000
+        if (prev_ExecutorRun)
+            prev_ExecutorRun(queryDesc, direction, count);
+        else
+            standard_ExecutorRun(queryDesc, direction, count);
+#else
+        if (prev_ExecutorRun)
+            prev_ExecutorRun(queryDesc, direction, count, execute_once);
+        else
+            standard_ExecutorRun(queryDesc, direction, count, execute_once);
+#endif
+    }
+    PG_FINALLY();
+    {
+        stats_flush(stats_current_queryid);
+        stats_current_queryid = saved_queryid;
+    }
+    PG_END_TRY();
+}
+
+/*
+ * ExecutorFinish hook: same attribution as stats_ExecutorRun (AFTER triggers
+ * and deferred work run here)
+ */
+static void
+stats_ExecutorFinish(QueryDesc *queryDesc)
+{
+    int64 saved_queryid = stats_current_queryid;
+
+    stats_flush(saved_queryid);
+    stats_current_queryid = (int64) queryDesc->plannedstmt->queryId;
+
+    PG_TRY();
+    {
+        if (prev_ExecutorFinish)
+            prev_ExecutorFinish(queryDesc);
+        else
+            standard_ExecutorFinish(queryDesc);
+    }
+    PG_FINALLY();
+    {
+        stats_flush(stats_current_queryid);
+        stats_current_queryid = saved_queryid;
+    }
+    PG_END_TRY();
+}
+
+/*
+ * Set up GUCs, shared memory and hooks
+ *
+ * Called from _PG_init(). Does nothing unless the library is being loaded
+ * through shared_preload_libraries.
+ */
+void
+ethiopian_stats_init(void)
+{
+    if (!process_shared_preload_libraries_in_progress)
+        return;
+
+    DefineCustomBoolVariable("ethiopian_calendar.track",
+                             "Collects per-query statistics for Ethiopian calendar functions.",
+                             "Routes every call through an fmgr hook (exception block and two hash lookups); "
+                             "leave off unless investigating.",
+                             &stats_track,
+                             false,
+                             PGC_SUSET,
+                             0,
+                             NULL, NULL, NULL);
+
+    DefineCustomBoolVariable("ethiopian_calendar.track_timing",
+                             "Collects time spent in Ethiopian calendar functions.",
+                             "Reads the clock twice per call; leave off unless investigating.",
+                             &stats_track_timing,
+                             false,
+                             PGC_SUSET,
+                             0,
+                             NULL, NULL, NULL);
+
+    DefineCustomIntVariable("ethiopian_calendar.max_tracked",
+                            "Maximum number of (statement, function) pairs tracked.",
+                            NULL,
+                            &stats_max,
+                            5000,
+                            100,
+                            INT_MAX / 2,
+                            PGC_POSTMASTER,
+                            0,
+                            NULL, NULL, NULL);
+
+#if PG_VERSION_NUM >= 140000
+    /* Compute queryids the same way pg_stat_statements does */
+    EnableQueryId();
+#endif
+
+#if PG_VERSION_NUM >= 150000
+    prev_shmem_request_hook = shmem_request_hook;
+    shmem_request_hook = stats_shmem_request;
+#else
+    RequestAddinShmemSpace(stats_memsize());
+    RequestNamedLWLockTranche("ethiopian_calendar", 1);
+#endif
+    prev_shmem_startup_hook = shmem_startup_hook;
+    shmem_startup_hook = stats_shmem_startup;
+
+    prev_ExecutorRun = ExecutorRun_hook;
+    ExecutorRun_hook = stats_ExecutorRun;
+    prev_ExecutorFinish = ExecutorFinish_hook;
+    ExecutorFinish_hook = stats_ExecutorFinish;
+
+    prev_needs_fmgr_hook = needs_fmgr_hook;
+    needs_fmgr_hook = stats_needs_fmgr_hook;
+    prev_fmgr_hook = fmgr_hook;
+    fmgr_hook = stats_fmgr_hook;
+}
+
+/*
+ * PostgreSQL function: ethiopian_calendar_query_stats()
+ *
+ * Returns the collected statistics, one row per (database, queryid, function,
+ * engine).
+ *
+ * Returns: SETOF (dbid OID, queryid BIGINT, funcid OID, calls BIGINT,
+ *                 errors BIGINT, total_time DOUBLE PRECISION, engine TEXT)
+ */
+PG_FUNCTION_INFO_V1(ethiopian_calendar_query_stats);
+
+Datum
+ethiopian_calendar_query_stats(PG_FUNCTION_ARGS)
+{
+    ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+    TupleDesc tupdesc;
+    Tuplestorestate *tupstore;
+    MemoryContext oldcontext;
+    HASH_SEQ_STATUS hash_seq;
+    EthiopianStatsEntry *entry;
+
+    if (stats_shared == NULL || stats_hash == NULL)
+        ereport(ERROR,
+                (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+                 errmsg("ethiopian_calendar must be loaded via shared_preload_libraries")));
+
+    if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo) ||
+        (rsinfo->allowedModes & SFRM_Materialize) == 0)
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("set-valued function called in context that cannot accept a set")));
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("function returning record called in context that cannot accept type record")));
+
+    oldcontext = MemoryContextSwitchTo(rsinfo->econtext->ecxt_per_query_memory);
+    tupdesc = CreateTupleDescCopy(tupdesc);
+    tupstore = tuplestore_begin_heap(true, false, work_mem);
+    rsinfo->returnMode = SFRM_Materialize;
+    rsinfo->setResult = tupstore;
+    rsinfo->setDesc = tupdesc;
+    MemoryContextSwitchTo(oldcontext);
+
+    /* Include this backend's own not-yet-flushed counters */
+    stats_flush(stats_current_queryid);
+
+    LWLockAcquire(stats_shared->lock, LW_SHARED);
+
+    hash_seq_init(&hash_seq, stats_hash);
+    while ((entry = (EthiopianStatsEntry *) hash_seq_search(&hash_seq)) != NULL)
+    {
+        Datum values[7];
+        bool nulls[7] = {false, false, false, false, false, false, false};
+
+        values[0] = ObjectIdGetDatum(entry->key.dbid);
+        values[1] = Int64GetDatum(entry->key.queryid);
+        values[2] = ObjectIdGetDatum(entry->key.funcid);
+        values[3] = Int64GetDatum(entry->calls);
+        values[4] = Int64GetDatum(entry->errors);
+        values[5] = Float8GetDatum(entry->total_time);
+        values[6] = CStringGetTextDatum(ethiopian_engine_name(entry->key.engine));
+
+        tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+    }
+
+    LWLockRelease(stats_shared->lock);
+
+    return (Datum) 0;
+}
+
+/*
+ * PostgreSQL function: ethiopian_calendar_query_stats_reset()
+ *
+ * Discards all collected statistics.
+ */
+PG_FUNCTION_INFO_V1(ethiopian_calendar_query_stats_reset);
+
+Datum
+ethiopian_calendar_query_stats_reset(PG_FUNCTION_ARGS)
+{
+    HASH_SEQ_STATUS hash_seq;
+    EthiopianStatsEntry *entry;
+
+    if (stats_shared == NULL || stats_hash == NULL)
+        ereport(ERROR,
+                (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+                 errmsg("ethiopian_calendar must be loaded via shared_preload_libraries")));
+
+    LWLockAcquire(stats_shared->lock, LW_EXCLUSIVE);
+
+    hash_seq_init(&hash_seq, stats_hash);
+    while ((entry = (EthiopianStatsEntry *) hash_seq_search(&hash_seq)) != NULL)
+        hash_search(stats_hash, &entry->key, HASH_REMOVE, NULL);
+
+    LWLockRelease(stats_shared->lock);
+
+    PG_RETURN_VOID();
+}
@@ -0,0 +1,15 @@
+/*
+ * ethiopian_stats.h
+ *
+ * Per-query accounting of Ethiopian calendar function calls.
+ *
+ * Active only when the library is listed in shared_preload_libraries; see
+ * ethiopian_stats.c.
+ */
+
+#ifndef ETHIOPIAN_STATS_H
+#define ETHIOPIAN_STATS_H
+
+extern void ethiopian_stats_init(void);
+
+#endif                          /* ETHIOPIAN_STATS_H */
@@ -0,0 +1,172 @@
+/*
+ * fuzz_ethiopian_date.c
+ *
+ * Differential fuzzing harness for the hand-written date parser and
+ * formatter in src/ethiopian_core.h. Built from the PostgreSQL-independent
+ * core only, so it runs under libFuzzer or AFL without a server.
+ *
+ * For every input it checks that:
+ *   - parse_fixed_ethiopian_date() only accepts strings that
+ *     sscanf("%d-%d-%d") also accepts, with the same components, so
+ *     from_ethiopian_date() takes the same accept/reject decision and
+ *     returns the same value whichever path parses the string
+ *   - format_ethiopian_date() writes what snprintf("%04d-%02d-%02d") wrote
+ *     before it, and every valid date it formats parses back unchanged
+ *   - a day number taken from the input survives
+ *     jdn -> Ethiopian date -> text -> Ethiopian date -> jdn -> Ethiopian date
+ * Any difference aborts, which both fuzzers report as a crash.
+ *
+ * Build and run: see test/fuzz/run-fuzz.sh
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ethiopian_core.h"
+
+/* Longest input worth comparing; sscanf() results do not change past it */
+#define MAX_INPUT 64
+
+/* Last supported Gregorian day, 9999-12-31 */
+#define MAX_JDN 5373484
+
+static void
+fail(const char *what, const uint8_t *data, size_t size)
+{
+    size_t i;
+
+    fprintf(stderr, "MISMATCH: %s\ninput (%zu bytes):", what, size);
+    for (i = 0; i < size && i < MAX_INPUT; i++)
+        fprintf(stderr, " %02x", data[i]);
+    fprintf(stderr, "\n");
+    abort();
+}
+
+/* Validation rules of from_ethiopian_date() (check_ethiopian_date()) */
+static int
+passes_checks(int year, int month, int day)
+{
+    if (month < 1 || month > 13 || day < 1)
+        return 0;
+    if (month <= 12)
+        return day <= 30;
+    return day <= ((year % 4 == 3) ? 6 : 5);
+}
+
+/* Formats with both formatters and parses the result back */
+static void
+check_format(int year, int month, int day, const uint8_t *data, size_t size)
+{
+    char buf[ETHIOPIAN_DATE_BUFLEN];
+    char expected[32];
+    int len;
+    int y, m, d;
+
+    len = format_ethiopian_date(buf, year, month, day);
+    snprintf(expected, sizeof(expected), "%04d-%02d-%02d", year, month, day);
+    if (len != (int) strlen(buf) || strcmp(buf, expected) != 0)
+        fail("format_ethiopian_date() differs from snprintf()", data, size);
+
+    if (year <= 9999)
+    {
+        if (!parse_fixed_ethiopian_date(buf, len, &y, &m, &d))
+            fail("formatted date rejected by the fast parser", data, size);
+    }
+    else if (sscanf(buf, "%d-%d-%d", &y, &m, &d) != 3)
+        fail("formatted date rejected by sscanf()", data, size);
+
+    if (y != year || m != month || d != day)
+        fail("formatted date does not parse back", data, size);
+}
+
+int
+LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    char str[MAX_INPUT + 1];
+    size_t len = size < MAX_INPUT ? size : MAX_INPUT;
+    int fast, year = 0, month = 0, day = 0;
+    int ref, ref_year = 0, ref_month = 0, ref_day = 0;
+
+    /* from_ethiopian_date() hands the parsers the text bytes, unterminated */
+    fast = parse_fixed_ethiopian_date((const char *) data, (int) size, &year, &month, &day);
+
+    /* The scalar path copies the bytes (pnstrdup stops at a NUL) for sscanf() */
+    memcpy(str, data, len);
+    str[len] = '\0';
+    ref = sscanf(str, "%d-%d-%d", &ref_year, &ref_month, &ref_day) == 3;
+
+    if (fast)
+    {
+        if (!ref)
+            fail("fast parser accepts what sscanf() rejects", data, size);
+        if (year != ref_year || month != ref_month || day != ref_day)
+            fail("fast parser and sscanf() disagree on the components", data, size);
+    }
+
+    if (fast && passes_checks(year, month, day) && year >= 1)
+        check_format(year, month, day, data, size);
+    if (ref && passes_checks(ref_year, ref_month, ref_day) && ref_year >= 1)
+        check_format(ref_year, ref_month, ref_day, data, size);
+
+    /* Round trip of a day number taken from the first four bytes */
+    if (size >= 4)
+    {
+        uint32_t raw;
+        int jdn, y, m, d, y2, m2, d2;
+
+        memcpy(&raw, data, sizeof(raw));
+        jdn = ETHIOPIAN_EPOCH + (int) (raw % (uint32_t) (MAX_JDN - ETHIOPIAN_EPOCH + 1));
+
+        jdn_to_ethiopian(jdn, &y, &m, &d);
+        if (!ethiopian_date_is_valid(y, m, d))
+            fail("jdn_to_ethiopian() returned an invalid date", data, size);
+        check_format(y, m, d, data, size);
+
+        /* Pagumē 6 of years with year % 4 == 0 is clamped, so compare dates */
+        jdn_to_ethiopian(ethiopian_to_jdn(y, m, d), &y2, &m2, &d2);
+        if (y2 != y || m2 != m || d2 != d)
+            fail("Ethiopian date does not round-trip through its day number", data, size);
+    }
+
+    return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+/*
+ * Driver for AFL and for replaying a corpus without libFuzzer: each file
+ * argument is one input, or stdin when there are none.
+ */
+static void
+run_stream(FILE *f)
+{
+    static uint8_t buf[1 << 16];
+    size_t size = fread(buf, 1, sizeof(buf), f);
+
+    LLVMFuzzerTestOneInput(buf, size);
+}
+
+int
+main(int argc, char **argv)
+{
+    int i;
+
+    if (argc < 2)
+        run_stream(stdin);
+
+    for (i = 1; i < argc; i++)
+    {
+        FILE *f = fopen(argv[i], "rb");
+
+        if (f == NULL)
+        {
+            perror(argv[i]);
+            return 1;
+        }
+        run_stream(f);
+        fclose(f);
+    }
+    return 0;
+}
+#endif
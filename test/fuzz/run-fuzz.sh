@@ -0,0 +1,39 @@
+#!/bin/bash
+# Builds and runs the differential fuzzer for the date parser and formatter.
+#
+# With clang, runs libFuzzer (with ASan and UBSan) on a copy of the seed
+# corpus for FUZZ_SECONDS. Without clang, or with REPLAY=1, builds the
+# standalone driver and replays the seed corpus once, which is quick enough
+# for a pre-commit check.
+#
+# Usage:
+#   test/fuzz/run-fuzz.sh                   # 60 seconds of libFuzzer
+#   FUZZ_SECONDS=600 test/fuzz/run-fuzz.sh
+#   REPLAY=1 test/fuzz/run-fuzz.sh          # replay the corpus only
+#
+# AFL++:
+#   afl-clang-fast -O2 -DFUZZ_STANDALONE -I src -o fuzz_afl test/fuzz/fuzz_ethiopian_date.c
+#   afl-fuzz -i test/fuzz/corpus -o /tmp/afl-out -- ./fuzz_afl @@
+
+set -euo pipefail
+
+ROOT="$(cd "$(dirname "$0")/../.." && pwd)"
+SRC="$ROOT/test/fuzz/fuzz_ethiopian_date.c"
+CORPUS="$ROOT/test/fuzz/corpus"
+FUZZ_SECONDS="${FUZZ_SECONDS:-60}"
+WORK="${TMPDIR:-/tmp}/fuzz_ethiopian_date.$$"
+
+mkdir -p "$WORK"
+trap 'rm -rf "$WORK"' EXIT
+
+if [ -z "${REPLAY:-}" ] && command -v clang >/dev/null; then
+    clang -g -O1 -fsanitize=fuzzer,address,undefined -fno-sanitize-recover=undefined \
+        -I "$ROOT/src" -o "$WORK/fuzz" "$SRC"
+    # New inputs go to the scratch copy, the checked-in seeds stay small
+    cp -r "$CORPUS" "$WORK/corpus"
+    "$WORK/fuzz" -max_total_time="$FUZZ_SECONDS" -max_len=64 "$WORK/corpus"
+else
+    "${CC:-cc}" -O2 -Wall -DFUZZ_STANDALONE -I "$ROOT/src" -o "$WORK/fuzz" "$SRC"
+    "$WORK/fuzz" "$CORPUS"/*
+    echo "Replayed $(ls "$CORPUS" | wc -l) corpus inputs without mismatches"
+fi
@@ -92,19 +92,34 @@ EOF
 
 echo -e "${YELLOW}Running pgTAP tests...${NC}"
 
+# Performance tests compare against a baseline measured on this machine;
+# RUN_PERF_TESTS=0 skips them, PERF_FACTOR sets the allowed slowdown
+TEST_FILES="test/tests/ethiopian_calendar_tests.sql"
+if [ "${RUN_PERF_TESTS:-1}" != "0" ]; then
+    TEST_FILES="$TEST_FILES test/tests/ethiopian_calendar_perf_tests.sql"
+    export PGOPTIONS="${PGOPTIONS:-} -c ethiopian_calendar_tests.perf_factor=${PERF_FACTOR:-3}"
+else
+    echo -e "${YELLOW}Skipping performance tests (RUN_PERF_TESTS=0)${NC}"
+fi
+
 # Check if pg_prove is available
+# (set +e so a failing file still reports its exit code)
+set +e
 if command -v pg_prove &> /dev/null; then
     # Run tests using pg_prove
     cd /usr/src/extension
-    pg_prove -h "$PGHOST" -p "$PGPORT" -U "$PGUSER" -d "$PGDB" test/tests/ethiopian_calendar_tests.sql
+    pg_prove -h "$PGHOST" -p "$PGPORT" -U "$PGUSER" -d "$PGDB" $TEST_FILES
     TEST_EXIT_CODE=$?
 else
     # Fallback: run tests directly with psql
     echo -e "${YELLOW}pg_prove not found, running tests with psql...${NC}"
     cd /usr/src/extension
-    psql -h "$PGHOST" -p "$PGPORT" -U "$PGUSER" -d "$PGDB" -f test/tests/ethiopian_calendar_tests.sql
-    TEST_EXIT_CODE=$?
+    TEST_EXIT_CODE=0
+    for TEST_FILE in $TEST_FILES; do
+        psql -h "$PGHOST" -p "$PGPORT" -U "$PGUSER" -d "$PGDB" -v ON_ERROR_STOP=1 -f "$TEST_FILE" || TEST_EXIT_CODE=$?
+    done
 fi
+set -e
 
 if [ $TEST_EXIT_CODE -eq 0 ]; then
     echo -e "${GREEN}All tests passed!${NC}"
@@ -3,6 +3,9 @@ set -e
 
 # Start PostgreSQL in the background.
 # pgtest.sh already polls pg_isready in a loop, so no sleep is needed here.
-docker-entrypoint.sh postgres &
+# The library is preloaded and tracking turned on so the per-query
+# statistics tests run too.
+docker-entrypoint.sh postgres -c shared_preload_libraries=ethiopian_calendar \
+    -c ethiopian_calendar.track=on &
 
 exec /usr/src/extension/test/pgtest.sh
@@ -0,0 +1,101 @@
+-- pgTAP performance tests for pg_ethiopian_calendar extension
+-- Times the core conversion paths over large generated inputs against a
+-- built-in baseline doing comparable work on the same machine
+--
+-- Each test fails when the extension query takes longer than
+-- baseline * factor. The factor defaults to 3 and can be changed with
+--   PGOPTIONS="-c ethiopian_calendar_tests.perf_factor=5"
+-- (test/pgtest.sh sets this from PERF_FACTOR).
+
+BEGIN;
+
+SELECT plan(6);
+
+-- Input: 200,000 consecutive days (1900-01-01 .. 2447-07-31) with varying times
+CREATE TEMP TABLE perf_input AS
+SELECT ts,
+       to_char(ts, 'YYYY-MM-DD') AS gregorian_text,
+       to_ethiopian_date(ts) AS ethiopian_text
+FROM (
+    SELECT '1900-01-01'::timestamp + g * interval '1 day' + (g % 86400) * interval '1 second' AS ts
+    FROM generate_series(0, 199999) g
+) s;
+
+-- Best of three runs in milliseconds, after one warm-up run
+CREATE FUNCTION pg_temp.perf_ms(query text) RETURNS double precision
+LANGUAGE plpgsql AS $$
+DECLARE
+    started timestamptz;
+    elapsed double precision;
+    best double precision;
+BEGIN
+    EXECUTE query;
+    FOR i IN 1..3 LOOP
+        started := clock_timestamp();
+        EXECUTE query;
+        elapsed := extract(epoch FROM clock_timestamp() - started) * 1000;
+        best := least(best, elapsed);
+    END LOOP;
+    RETURN best;
+END
+$$;
+
+-- Time budget for a test: baseline * factor, with a 10 ms floor against timer noise
+CREATE FUNCTION pg_temp.perf_budget(baseline text) RETURNS double precision
+LANGUAGE sql AS $$
+    SELECT greatest(
+        pg_temp.perf_ms(baseline)
+            * coalesce(nullif(current_setting('ethiopian_calendar_tests.perf_factor', true), '')::double precision, 3.0),
+        10.0)
+$$;
+
+-- Test 1: to_ethiopian_date vs to_char
+SELECT cmp_ok(
+    pg_temp.perf_ms('SELECT count(to_ethiopian_date(ts)) FROM perf_input'),
+    '<=',
+    pg_temp.perf_budget($$SELECT count(to_char(ts, 'YYYY-MM-DD')) FROM perf_input$$),
+    'to_ethiopian_date over 200k rows should stay within budget of to_char'
+);
+
+-- Test 2: to_ethiopian_timestamp vs to_char
+SELECT cmp_ok(
+    pg_temp.perf_ms('SELECT count(to_ethiopian_timestamp(ts)) FROM perf_input'),
+    '<=',
+    pg_temp.perf_budget($$SELECT count(to_char(ts, 'YYYY-MM-DD')) FROM perf_input$$),
+    'to_ethiopian_timestamp over 200k rows should stay within budget of to_char'
+);
+
+-- Test 3: to_ethiopian_datetime vs to_char
+SELECT cmp_ok(
+    pg_temp.perf_ms('SELECT count(to_ethiopian_datetime(ts)) FROM perf_input'),
+    '<=',
+    pg_temp.perf_budget($$SELECT count(to_char(ts, 'YYYY-MM-DD')) FROM perf_input$$),
+    'to_ethiopian_datetime over 200k rows should stay within budget of to_char'
+);
+
+-- Test 4: from_ethiopian_date vs text-to-date cast
+SELECT cmp_ok(
+    pg_temp.perf_ms('SELECT count(from_ethiopian_date(ethiopian_text)) FROM perf_input'),
+    '<=',
+    pg_temp.perf_budget('SELECT count(gregorian_text::date) FROM perf_input'),
+    'from_ethiopian_date over 200k rows should stay within budget of a date cast'
+);
+
+-- Test 5: ethiopian_date_part vs date_part
+SELECT cmp_ok(
+    pg_temp.perf_ms($$SELECT sum(ethiopian_date_part('month', ts)) FROM perf_input$$),
+    '<=',
+    pg_temp.perf_budget($$SELECT sum(date_part('month', ts)) FROM perf_input$$),
+    'ethiopian_date_part over 200k rows should stay within budget of date_part'
+);
+
+-- Test 6: daily ethiopian_buckets vs generate_series with labels
+SELECT cmp_ok(
+    pg_temp.perf_ms($$SELECT count(label) FROM ethiopian_buckets('1900-01-01', '2447-08-01', 'day')$$),
+    '<=',
+    pg_temp.perf_budget($$SELECT count(to_char(g, 'YYYY-MM-DD'))
+                          FROM generate_series('1900-01-01'::timestamp, '2447-07-31', '1 day') g$$),
+    'ethiopian_buckets over 200k days should stay within budget of generate_series'
+);
+
+ROLLBACK;
@@ -4,7 +4,7 @@
 BEGIN;
 
 -- Test 1: Extension loads correctly
-SELECT plan(35);
+SELECT plan(100);
 
 -- Test 2: Extension exists
 SELECT has_extension('pg_ethiopian_calendar', 'Extension pg_ethiopian_calendar should exist');
@@ -314,5 +314,513 @@ SELECT ok(
     'pg_ethiopian_to_timestamp alias should exist'
 );
 
+-- Test 36: ethiopian_date_text domain exists
+SELECT has_domain(
+    'ethiopian_date_text',
+    'Domain ethiopian_date_text should exist'
+);
+
+-- Test 37: Function to_ethiopian_date_text exists
+SELECT has_function(
+    'public',
+    'to_ethiopian_date_text',
+    ARRAY['timestamp without time zone'],
+    'Function to_ethiopian_date_text should exist'
+);
+
+-- Test 38: to_ethiopian_date_text returns the same value as to_ethiopian_date
+SELECT is(
+    to_ethiopian_date_text('2024-01-01 14:30:00'::timestamp)::text,
+    to_ethiopian_date('2024-01-01 14:30:00'::timestamp),
+    'to_ethiopian_date_text should match to_ethiopian_date'
+);
+
+-- Test 39: to_ethiopian_date_text results use the "C" collation
+SELECT is(
+    COLLATION FOR (to_ethiopian_date_text('2024-01-01'::timestamp)),
+    '"C"',
+    'to_ethiopian_date_text should return a "C"-collated value'
+);
+
+-- Test 40: Function ethiopian_buckets exists
+SELECT has_function(
+    'public',
+    'ethiopian_buckets',
+    ARRAY['timestamp without time zone', 'timestamp without time zone', 'text'],
+    'Function ethiopian_buckets should exist'
+);
+
+-- Test 41: One Ethiopian year has 13 month buckets
+SELECT is(
+    (SELECT count(*)::int FROM ethiopian_buckets('2023-09-11', '2024-09-11', 'month')),
+    13,
+    'ethiopian_buckets should return 13 month buckets for one Ethiopian year'
+);
+
+-- Test 42: Day bucket labels match to_ethiopian_date
+SELECT is(
+    (SELECT label FROM ethiopian_buckets('2024-01-01', '2024-01-02', 'day')),
+    to_ethiopian_date('2024-01-01'::timestamp),
+    'ethiopian_buckets day label should match to_ethiopian_date'
+);
+
+-- Test 43: Buckets are contiguous (each bucket_end is the next bucket_start)
+SELECT ok(
+    NOT EXISTS (
+        SELECT 1
+        FROM (
+            SELECT bucket_end, lead(bucket_start) OVER (ORDER BY bucket_start) AS next_start
+            FROM ethiopian_buckets('2020-01-01', '2024-01-01', 'week')
+        ) b
+        WHERE next_start IS NOT NULL AND next_start <> bucket_end
+    ),
+    'ethiopian_buckets week buckets should be contiguous'
+);
+
+-- Test 44: Fiscal years run Hamle 1 to Sene 30
+SELECT is(
+    (SELECT label || ' ' || to_ethiopian_date(bucket_start)
+     FROM ethiopian_buckets('2024-01-01', '2024-01-02', 'fiscal_year')),
+    'FY2016 2015-11-01',
+    'ethiopian_buckets fiscal_year should start on Hamle 1'
+);
+
+-- Test 45: Unknown granularity is rejected
+SELECT throws_ok(
+    $$SELECT * FROM ethiopian_buckets('2024-01-01', '2024-02-01', 'fortnight')$$,
+    '22023',
+    NULL,
+    'ethiopian_buckets should reject unknown granularities'
+);
+
+-- Test 46: Function ethiopian_date_part exists
+SELECT has_function(
+    'public',
+    'ethiopian_date_part',
+    ARRAY['text', 'timestamp without time zone'],
+    'Function ethiopian_date_part should exist'
+);
+
+-- Test 47: ethiopian_date_part year/month/day match to_ethiopian_date
+SELECT is(
+    format('%s-%s-%s',
+           ethiopian_date_part('year', '2024-01-01'::timestamp),
+           lpad(ethiopian_date_part('month', '2024-01-01'::timestamp)::text, 2, '0'),
+           lpad(ethiopian_date_part('day', '2024-01-01'::timestamp)::text, 2, '0')),
+    to_ethiopian_date('2024-01-01'::timestamp),
+    'ethiopian_date_part year/month/day should match to_ethiopian_date'
+);
+
+-- Test 48: dow follows date_part (0 = Sunday)
+SELECT is(
+    ethiopian_date_part('dow', '2024-01-01'::timestamp),
+    date_part('dow', '2024-01-01'::timestamp),
+    'ethiopian_date_part dow should match date_part dow'
+);
+
+-- Test 49: leap is 1 in Ethiopian leap years (year % 4 == 3)
+SELECT is(
+    ethiopian_date_part('leap', '2023-01-01'::timestamp),
+    1::double precision,
+    'ethiopian_date_part leap should be 1 in Ethiopian year 2015'
+);
+
+-- Test 50: Non-constant fields use the generic path
+SELECT is(
+    (SELECT array_agg(ethiopian_date_part(f, '2024-01-01'::timestamp) ORDER BY f)
+     FROM unnest(ARRAY['DAY', 'month', 'year', 'quarter']) f),
+    ARRAY[23, 4, 2, 2016]::double precision[],
+    'ethiopian_date_part should handle per-row fields'
+);
+
+-- Test 51: Constant fields are simplified into the matching extractor
+CREATE FUNCTION pg_temp.explain_text(query text)
+RETURNS text
+LANGUAGE plpgsql
+AS $$
+DECLARE
+    line text;
+    result text := '';
+BEGIN
+    FOR line IN EXECUTE 'EXPLAIN (VERBOSE, COSTS OFF) ' || query LOOP
+        result := result || line || E'\n';
+    END LOOP;
+    RETURN result;
+END;
+$$;
+
+SELECT matches(
+    pg_temp.explain_text($$SELECT ethiopian_date_part('month', ts) FROM (VALUES ('2024-01-01'::timestamp)) v(ts)$$),
+    'ethiopian_month\(',
+    'ethiopian_date_part with a constant field should plan as ethiopian_month()'
+);
+
+-- Test 52: Unknown fields are rejected
+SELECT throws_ok(
+    $$SELECT ethiopian_date_part('century', '2024-01-01'::timestamp)$$,
+    '22023',
+    NULL,
+    'ethiopian_date_part should reject unknown fields'
+);
+
+-- Test 53: Per-query statistics
+SELECT has_view('ethiopian_calendar_query_stats', 'ethiopian_calendar_query_stats view should exist');
+SELECT has_function('ethiopian_calendar_query_stats_reset', 'ethiopian_calendar_query_stats_reset function should exist');
+
+-- Statistics are only collected when the library is preloaded and tracking is on
+-- (test/run-tests.sh does both)
+SELECT CASE WHEN current_setting('shared_preload_libraries') ~ 'ethiopian_calendar'
+            AND current_setting('ethiopian_calendar.track', true) = 'on' THEN
+    collect_tap(
+        lives_ok('SELECT ethiopian_calendar_query_stats_reset()', 'ethiopian_calendar_query_stats_reset should succeed'),
+        is((SELECT count(to_ethiopian_date(g))
+            FROM generate_series('2024-01-01'::timestamp, '2024-01-10'::timestamp, '1 day') g),
+           10::bigint, 'Tracked statement should convert 10 rows')
+    )
+ELSE skip('ethiopian_calendar is not preloaded with tracking on', 2) END;
+
+SELECT CASE WHEN current_setting('shared_preload_libraries') ~ 'ethiopian_calendar'
+            AND current_setting('ethiopian_calendar.track', true) = 'on' THEN
+    ok(EXISTS (SELECT 1 FROM ethiopian_calendar_query_stats
+               WHERE function = 'to_ethiopian_date(timestamp)'::regprocedure
+                 AND dbid = (SELECT oid FROM pg_database WHERE datname = current_database())
+                 AND queryid <> 0
+                 AND calls = 10
+                 AND errors = 0),
+       'ethiopian_calendar_query_stats should attribute 10 calls to the converting statement')
+ELSE skip('ethiopian_calendar is not preloaded with tracking on', 1) END;
+
+-- SECURITY DEFINER functions also go through the fmgr hook but are not counted
+CREATE FUNCTION eth_stats_secdef(ts timestamp) RETURNS text
+LANGUAGE plpgsql SECURITY DEFINER AS $$ BEGIN RETURN to_ethiopian_date(ts); END $$;
+
+SELECT CASE WHEN current_setting('shared_preload_libraries') ~ 'ethiopian_calendar'
+            AND current_setting('ethiopian_calendar.track', true) = 'on' THEN
+    is((SELECT count(eth_stats_secdef(g))
+        FROM generate_series('2024-01-01'::timestamp, '2024-01-05'::timestamp, '1 day') g),
+       5::bigint, 'SECURITY DEFINER wrapper should convert 5 rows')
+ELSE skip('ethiopian_calendar is not preloaded with tracking on', 1) END;
+
+SELECT CASE WHEN current_setting('shared_preload_libraries') ~ 'ethiopian_calendar'
+            AND current_setting('ethiopian_calendar.track', true) = 'on' THEN
+    ok(NOT EXISTS (SELECT 1 FROM ethiopian_calendar_query_stats
+                   WHERE function = 'eth_stats_secdef(timestamp)'::regprocedure),
+       'ethiopian_calendar_query_stats should not count SECURITY DEFINER functions')
+ELSE skip('ethiopian_calendar is not preloaded with tracking on', 1) END;
+
+-- Test 54: Implementation marker shared with the npm SQL variants
+SELECT is(
+    ethiopian_calendar_implementation(),
+    'c-extension',
+    'ethiopian_calendar_implementation() should report the C extension'
+);
+
+-- Test 55: Schema advisor: stored Ethiopian TEXT column and expression index
+CREATE TABLE advise_orders (
+    created_at timestamp NOT NULL,
+    created_eth text GENERATED ALWAYS AS (to_ethiopian_date(created_at)) STORED
+);
+CREATE INDEX advise_orders_eth_month ON advise_orders (ethiopian_month(created_at));
+
+SELECT ok(
+    EXISTS (SELECT 1 FROM ethiopian_calendar_advise()
+            WHERE category = 'stored_ethiopian_text' AND object_name = 'advise_orders.created_eth'),
+    'ethiopian_calendar_advise should report a generated column fed by to_ethiopian_date'
+);
+
+SELECT ok(
+    EXISTS (SELECT 1 FROM ethiopian_calendar_advise()
+            WHERE category = 'expression_index' AND object_name = 'advise_orders_eth_month'
+              AND suggestion LIKE '%created_at%'),
+    'ethiopian_calendar_advise should report an expression index and its source column'
+);
+
+-- Test 56: Recurrence rules: days past the end of Pagumē stay in Pagumē
+SELECT is(
+    (SELECT array_agg(to_ethiopian_date(o))
+     FROM ethiopian_recurrence('FREQ=MONTHLY;INTERVAL=2;DAY=30', from_ethiopian_date('2016-01-01'), count => 7) o),
+    ARRAY['2016-01-30', '2016-03-30', '2016-05-30', '2016-07-30', '2016-09-30', '2016-11-30', '2016-13-05'],
+    'ethiopian_recurrence should clamp day 30 to the length of Pagumē'
+);
+
+SELECT is(
+    (SELECT array_agg(substr(to_ethiopian_date(o), 1, 8))
+     FROM ethiopian_recurrence('FREQ=YEARLY;MONTH=13;DAY=6', from_ethiopian_date('2014-01-01'), count => 4) o),
+    ARRAY['2014-13-', '2015-13-', '2016-13-', '2017-13-'],
+    'ethiopian_recurrence should keep Pagumē 6 inside Pagumē of the same year'
+);
+
+SELECT is(
+    (SELECT array_agg(substr(to_ethiopian_date(o), 1, 8))
+     FROM ethiopian_recurrence('FREQ=MONTHLY;DAY=-1', from_ethiopian_date('2015-12-01'), count => 3) o),
+    ARRAY['2015-12-', '2015-13-', '2016-01-'],
+    'ethiopian_recurrence should keep the last day of Pagumē inside Pagumē'
+);
+
+SELECT is(
+    (SELECT array_agg(to_ethiopian_date(o))
+     FROM ethiopian_recurrence('freq=yearly; month=1; day=17', from_ethiopian_date('2016-01-20') + interval '9 hours',
+                               until => from_ethiopian_date('2019-01-17') + interval '9 hours') o),
+    ARRAY['2017-01-17', '2018-01-17', '2019-01-17'],
+    'ethiopian_recurrence should skip occurrences before start and include until'
+);
+
+SELECT throws_ok(
+    $$SELECT * FROM ethiopian_recurrence('FREQ=DAILY', '2024-01-01')$$,
+    '22023',
+    NULL,
+    'ethiopian_recurrence should require until or count'
+);
+
+-- Test 57: Batch parsing: fixed-layout, irregular and NULL elements match the scalar function
+SELECT is(
+    from_ethiopian_date(ARRAY['2016-04-23', '2015-13-06', '2016-1-5', NULL, ' 2017-01-01']),
+    ARRAY[from_ethiopian_date('2016-04-23'), from_ethiopian_date('2015-13-06'),
+          from_ethiopian_date('2016-1-5'), NULL, from_ethiopian_date('2017-01-01')],
+    'from_ethiopian_date(text[]) should match from_ethiopian_date(text) element by element'
+);
+
+SELECT throws_ok(
+    $$SELECT from_ethiopian_date(ARRAY['2016-01-01', '2016-13-06'])$$,
+    '22008',
+    NULL,
+    'from_ethiopian_date(text[]) should reject an invalid element'
+);
+
+-- Test 58: Conversion engines: every kernel matches the reference one
+SET LOCAL ethiopian_calendar.engine = 'reference';
+CREATE TEMP TABLE engine_reference AS
+SELECT ts, to_ethiopian_date(ts) AS eth_date, ethiopian_day_of_year(ts) AS day_of_year
+FROM generate_series(timestamp '2010-09-01', timestamp '2030-09-30', interval '1 day') ts;
+
+SET LOCAL ethiopian_calendar.engine = 'fast';
+CREATE TEMP TABLE engine_fast AS
+SELECT ts, to_ethiopian_date(ts) AS eth_date, ethiopian_day_of_year(ts) AS day_of_year
+FROM engine_reference;
+
+SET LOCAL ethiopian_calendar.engine = 'lookup';
+CREATE TEMP TABLE engine_lookup AS
+SELECT ts, to_ethiopian_date(ts) AS eth_date, ethiopian_day_of_year(ts) AS day_of_year
+FROM engine_reference;
+
+RESET ethiopian_calendar.engine;
+
+SELECT is(
+    (SELECT count(*)::int FROM engine_reference r
+     JOIN engine_fast f USING (ts) JOIN engine_lookup l USING (ts)
+     WHERE (f.eth_date, f.day_of_year) IS DISTINCT FROM (r.eth_date, r.day_of_year)
+        OR (l.eth_date, l.day_of_year) IS DISTINCT FROM (r.eth_date, r.day_of_year)),
+    0,
+    'ethiopian_calendar.engine kernels should all match the reference kernel'
+);
+
+SELECT throws_ok(
+    $$SET ethiopian_calendar.engine = 'simd'$$,
+    '22023',
+    NULL,
+    'ethiopian_calendar.engine should reject unknown engines'
+);
+
+-- Test 59: Shadow verification: every sampled conversion matches the reference code
+SET LOCAL ethiopian_calendar.verify_sample_rate = 1;
+
+-- OFFSET 0 keeps from_ethiopian_date(to_ethiopian_date(ts)) from being folded into one call
+SELECT is(
+    (SELECT (count(from_ethiopian_date(eth_date)) + count(to_ethiopian_timestamp(ts)))::int
+     FROM (SELECT ts, to_ethiopian_date(ts) AS eth_date
+           FROM generate_series(timestamp '2023-09-01', timestamp '2023-09-30', interval '1 day') ts
+           OFFSET 0) AS s),
+    60,
+    'Conversions should succeed with ethiopian_calendar.verify_sample_rate = 1'
+);
+
+SELECT is(
+    (SELECT (sample_rate, checks >= 90, mismatches)::text FROM ethiopian_calendar_verify_stats()),
+    '(1,t,0)',
+    'ethiopian_calendar_verify_stats should count sampled checks without mismatches'
+);
+
+-- Parse cache hits are sampled too: 40 calls on two distinct strings
+CREATE TEMP TABLE verify_before AS SELECT * FROM ethiopian_calendar_verify_stats();
+
+SELECT is(
+    (SELECT count(from_ethiopian_date((ARRAY['2016-04-23', '2016-04-24'])[1 + i % 2]))::int
+     FROM generate_series(1, 40) i),
+    40,
+    'Repeated strings should convert with ethiopian_calendar.verify_sample_rate = 1'
+);
+
+SELECT is(
+    (SELECT (a.checks - b.checks >= 40, a.mismatches - b.mismatches)::text
+     FROM ethiopian_calendar_verify_stats() a, verify_before b),
+    '(t,0)',
+    'Shadow verification should also check parse cache hits'
+);
+
+RESET ethiopian_calendar.verify_sample_rate;
+
+-- Test 60: Ethiopian date and time parsing
+SELECT is(
+    from_ethiopian_timestamp('2016-13-05 14:30:15.123'),
+    from_ethiopian_date('2016-13-05') + interval '14:30:15.123',
+    'from_ethiopian_timestamp should keep the time of day'
+);
+
+SELECT is(
+    from_ethiopian_timestamp('2016-04-23T20:15', ethiopian_hours => true),
+    from_ethiopian_date('2016-04-24') + interval '02:15',
+    'from_ethiopian_timestamp should count Ethiopian hours from 06:00'
+);
+
+SELECT throws_ok(
+    $$SELECT from_ethiopian_timestamp('2016-04-23 12:60')$$,
+    '22008',
+    NULL,
+    'from_ethiopian_timestamp should reject an invalid time'
+);
+
+-- Test 61: Inverse conversion pairs are folded at plan time
+CREATE TEMP TABLE conversion_rows (ts timestamp, eth_date text);
+INSERT INTO conversion_rows VALUES ('2024-01-01 13:45', '2016-4-3');
+
+SELECT matches(
+    pg_temp.explain_text($$SELECT pg_ethiopian_to_date(from_ethiopian_date(eth_date)) FROM conversion_rows$$),
+    '_ethiopian_normalize_date\(conversion_rows\.eth_date\)',
+    'to_ethiopian_date(from_ethiopian_date(x)) should plan as _ethiopian_normalize_date(x)'
+);
+
+SELECT matches(
+    pg_temp.explain_text($$SELECT from_ethiopian_date(to_ethiopian_date_text(ts))::date FROM conversion_rows$$),
+    '_ethiopian_day_trunc\(conversion_rows\.ts\)',
+    'from_ethiopian_date(to_ethiopian_date_text(ts)) should plan as _ethiopian_day_trunc(ts)'
+);
+
+SELECT is(
+    (SELECT (to_ethiopian_date(from_ethiopian_date(eth_date)), from_ethiopian_date(to_ethiopian_date(ts)))::text
+     FROM conversion_rows),
+    '(2016-04-03,"2024-01-01 00:00:00")',
+    'Folded conversion pairs should return the unfolded results'
+);
+
+-- Test 62: B-tree deduplication: indexes on Ethiopian values only use opclasses with equalimage
+CREATE TEMP TABLE dedup_events (created_at timestamp);
+CREATE INDEX dedup_events_eth_date ON dedup_events (to_ethiopian_date_text(created_at));
+CREATE INDEX dedup_events_eth_ts ON dedup_events (to_ethiopian_timestamp(created_at));
+CREATE INDEX dedup_events_eth_month ON dedup_events (ethiopian_year(created_at), ethiopian_month(created_at));
+
+SELECT CASE WHEN current_setting('server_version_num')::int >= 130000 THEN
+    is((SELECT count(*)::int
+        FROM pg_index i
+        CROSS JOIN LATERAL unnest(i.indclass::oid[]) AS k(opclass)
+        JOIN pg_opclass c ON c.oid = k.opclass
+        WHERE i.indrelid = 'dedup_events'::regclass
+          AND NOT EXISTS (SELECT 1 FROM pg_amproc p
+                          WHERE p.amprocfamily = c.opcfamily AND p.amprocnum = 4
+                            AND p.amproclefttype = c.opcintype)),
+       0,
+       'Indexes on Ethiopian values should be eligible for B-tree deduplication')
+ELSE skip('B-tree deduplication needs PostgreSQL 13', 1) END;
+
+-- Test 63: ethiopian_date_set text form, construction and set operators
+SELECT is(
+    '{2024-01-05, 2024-01-01..2024-01-03, 2024-01-02, 2024-01-08}'::ethiopian_date_set::text,
+    '{2024-01-01..2024-01-03,2024-01-05,2024-01-08}',
+    'ethiopian_date_set should sort, merge and print runs as ranges'
+);
+
+SELECT is(
+    (SELECT (ethiopian_date_set_count(s), s @> date '2024-09-13', s @> date '2024-09-14',
+             s @> timestamp '2024-10-10 17:30', date '2024-10-11' <@ s)::text
+     FROM (SELECT ethiopian_date_set('2017-01-01', '2017-01-30', ARRAY[1, 2, 3, 4, 5]) AS s) AS t),
+    '(22,t,f,t,f)',
+    'ethiopian_date_set should build from an Ethiopian range filtered by day of week'
+);
+
+SELECT is(
+    ('{2024-01-01..2024-01-10}'::ethiopian_date_set | ARRAY[date '2024-01-20']::ethiopian_date_set)::text
+    || ' ' ||
+    ('{2024-01-01..2024-01-10}'::ethiopian_date_set & '{2024-01-08..2024-01-20}'::ethiopian_date_set)::text,
+    '{2024-01-01..2024-01-10,2024-01-20} {2024-01-08..2024-01-10}',
+    'ethiopian_date_set should support union and intersection'
+);
+
+-- Test 64: ethiopian_date_set rejects days outside 0001-01-01..9999-12-31
+SELECT throws_ok(
+    $$SELECT ARRAY[date '2024-01-01', date '10000-01-01']::ethiopian_date_set$$,
+    '22008',
+    NULL,
+    'ethiopian_date_set cast should reject dates after 9999-12-31'
+);
+
+SELECT throws_ok(
+    $$SELECT ARRAY[date '0001-12-31 BC']::ethiopian_date_set$$,
+    '22008',
+    NULL,
+    'ethiopian_date_set cast should reject dates before 0001-01-01'
+);
+
+SELECT throws_ok(
+    $$SELECT ethiopian_date_set('9999-01-01', '9999-01-05')$$,
+    '22008',
+    NULL,
+    'ethiopian_date_set range constructor should reject days past 9999-12-31'
+);
+
+-- Binary input: one day, 0x10000000 days after 2000-01-01
+CREATE TEMP TABLE date_set_copy (s ethiopian_date_set);
+SELECT CASE WHEN (SELECT rolsuper FROM pg_roles WHERE rolname = current_user) THEN
+    throws_ok(
+        $q$COPY date_set_copy FROM PROGRAM
+           $p$printf 'PGCOPY\n\377\r\n\000\000\000\000\000\000\000\000\000\000\001\000\000\000\010\000\000\000\001\020\000\000\000\377\377'$p$
+           WITH (FORMAT binary)$q$,
+        '22008',
+        NULL,
+        'ethiopian_date_set binary input should reject out-of-range days')
+ELSE skip('COPY FROM PROGRAM needs a superuser', 1) END;
+
+-- Test 65: Parse cache: repeated strings are answered without parsing
+CREATE TEMP TABLE parse_cache_before AS SELECT * FROM ethiopian_calendar_parse_cache_stats();
+
+SELECT is(
+    (SELECT array_agg(DISTINCT from_ethiopian_date(eth_date) ORDER BY from_ethiopian_date(eth_date))::text
+     FROM (SELECT (ARRAY['2016-04-23', '2016-13-05', '2016-4-23'])[1 + i % 3] AS eth_date
+           FROM generate_series(1, 300) i) AS s),
+    '{"2024-01-01 00:00:00","2024-09-09 00:00:00"}',
+    'from_ethiopian_date should give the same results for repeated strings'
+);
+
+SELECT is(
+    (SELECT (a.hits - b.hits, a.misses - b.misses)::text
+     FROM ethiopian_calendar_parse_cache_stats() a, parse_cache_before b),
+    '(297,3)',
+    'from_ethiopian_date should parse each distinct string once per call site'
+);
+
+-- Test 66: Infinite timestamps are out of range, not before the epoch
+SELECT throws_ok(
+    $$SELECT to_ethiopian_date('infinity'::timestamp)$$,
+    '22008',
+    'timestamp out of range',
+    'to_ethiopian_date should reject +infinity as out of range'
+);
+
+SELECT throws_ok(
+    $$SELECT to_ethiopian_timestamp('-infinity'::timestamp)$$,
+    '22008',
+    'timestamp out of range',
+    'to_ethiopian_timestamp should reject -infinity as out of range'
+);
+
+-- Test 67: Row estimates for ethiopian_buckets() never raise during planning
+SELECT lives_ok(
+    $$EXPLAIN SELECT * FROM ethiopian_buckets('2024-01-01', '2024-02-01', 'fortnight')$$,
+    'EXPLAIN should plan ethiopian_buckets with an unknown granularity'
+);
+
+SELECT lives_ok(
+    $$SELECT CASE WHEN false THEN (SELECT count(*) FROM ethiopian_buckets('0001-01-01', '0001-02-01', 'day')) END$$,
+    'A branch that never runs should plan ethiopian_buckets with a range before the epoch'
+);
+
 ROLLBACK;
 